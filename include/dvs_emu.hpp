@@ -4,11 +4,16 @@
 #include <iostream>
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include <opencv2/opencv.hpp>
 #include <opencv2/opencv_modules.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include "dvs_op.hpp"
+#include "dvs_params.hpp"
+#include "dvs_pyramid.hpp"
+#include "dvs_raw.hpp"
+#include "dvs_voxel.hpp"
 
 class PyDVS{
 
@@ -25,6 +30,12 @@ public:
     bool init(const char* filename, const float thr=12.75f,
               const float relaxRate=1.0f, const float adaptUp=1.0f, 
               const float adaptDown=1.0f);
+    bool initRaw(const std::string& path, const int format, const float thr=12.75f,
+                 const float relaxRate=1.0f, const float adaptUp=1.0f, 
+                 const float adaptDown=1.0f);
+    bool init(const cv::Size& size, const float thr=12.75f,
+              const float relaxRate=1.0f, const float adaptUp=1.0f, 
+              const float adaptDown=1.0f);
 
     void setFPS(const size_t fps);
     void setWidth(const size_t w);
@@ -32,6 +43,15 @@ public:
     void setRelaxRate(const float r);
     void setAdaptUp(const float u);
     void setAdaptDown(const float d);
+    void setOutputMode(const int mode);
+    void setStorage(const int storage);
+    void setLayout(const int layout);
+    void setStamps(const bool stamps);
+    void setColor(const bool color);
+    void setPyramid(const size_t levels);
+    void setRefractory(const size_t frames);
+    void setVoxelGrid(const std::string& path, const size_t bins,
+                      const size_t frames, const float ms=0.0f);
 
     size_t getFPS();
     size_t getWidth();
@@ -39,19 +59,41 @@ public:
     float getRelaxRate();
     float getAdaptUp();
     float getAdaptDown();
+    int getOutputMode();
+    int getStorage();
+    int getLayout();
+    bool getColor();
+    size_t getLevels();
+    size_t getRefractory();
+    size_t getVoxelBins();
+    size_t getVoxelCount();
+    bool isVoxelReady();
+    DVSParamBlock& getParamBlock();
     cv::Mat& getRaw();
     cv::Mat& getInput();
     cv::Mat& getReference();
     cv::Mat& getDifference();
     cv::Mat& getEvents();
     cv::Mat& getThreshold();
+    cv::Mat& getStamps();
+    cv::Mat& getVoxelGrid();
+    cv::Mat& getInput(const size_t level);
+    cv::Mat& getEvents(const size_t level);
+    cv::Mat& getReference(const size_t level);
+    cv::Mat& getThreshold(const size_t level);
 
+    bool read();
     bool update();
+    bool process(const cv::Mat& frame);
+    size_t updateBatch(const size_t k);
+    std::vector<cv::Mat>& getInputBatch();
+    std::vector<cv::Mat>& getEventsBatch();
     void setAdapt(const float relaxRate, const float adaptUp, 
                   const float adaptDown, const float threshold);
 
 private:
     cv::VideoCapture _cap;
+    DVSRawSource _raw;
     cv::Mat _in;
     cv::Mat _frame;
     cv::Mat _ref;
@@ -59,22 +101,56 @@ private:
     cv::Mat _thr;
     cv::Mat _events;
     cv::Mat _gray;
+    cv::Mat _refView;
+    cv::Mat _thrView;
+    cv::Mat _stamp;
+    cv::Mat _stampView;
+    cv::Mat _tiles;
+    std::vector<cv::Mat> _inBatch;
+    std::vector<cv::Mat> _eventsBatch;
 
     float _relaxRate;
     float _adaptUp;
     float _adaptDown;
     float _baseThresh;
+    int _outputMode;
+    int _storage;
+    int _layout;
+    bool _stamps;
+    bool _color;
+    size_t _levels;
+    size_t _refractory;
+
+    // Voxel grid output, window in frames or (when ms > 0) in milliseconds
+    std::string _voxelPath;
+    size_t _voxelBins;
+    size_t _voxelFrames;
+    float _voxelMs;
+    bool _voxelReady;
+
+    // Parameters published for the kernel, picked up between frames
+    DVSParamBlock _params;
+    uint32_t _paramsVersion;
 
     size_t _w, _h, _fps;
     bool _open;
     bool _is_vid;
+    bool _is_raw;
     DVSOperator _dvsOp;
+    DVSPyramid _pyramid;
+    DVSVoxelGrid _voxel;
 
     void _get_size();
     void _get_fps();
     bool _set_size();
     bool _set_fps();
     void _initMatrices(const float thr_init=-1.0f);
+    bool _grab(cv::Mat& in);
+    int _inputType() const;
+    void _pollParams();
+    void _mirrorParams(const DVSParams& params);
+    void _run();
+    void _publishParams();
 };
 
 
@@ -2,11 +2,44 @@
 #define DVS_OP_HPP
 
 #include <iostream>
+#include <stdint.h>
+#include <vector>
 #include "opencv2/opencv.hpp"
 #include "opencv2/core/core.hpp"
 #include "opencv2/highgui/highgui.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
 
+#include "dvs_params.hpp"
+
+// Storage format of the per-pixel ref/thr state
+enum DVSStorage
+{
+    DVS_STORAGE_FP32,
+    DVS_STORAGE_FP16, // half precision, diff is not materialized
+    DVS_STORAGE_BF16  // bfloat16, diff is not materialized
+};
+// Compact formats round every ref/thr update to 11 (FP16) or 8 (BF16)
+// significant bits: relax/up/down rates within storagePrecision() of 1
+// have no effect on the stored state.
+
+// Interleaved layout groups this many pixels per tile
+static const int DVS_TILE {16};
+
+// State layout in memory
+enum DVSLayout
+{
+    DVS_LAYOUT_PLANAR,      // separate ref/thr images
+    DVS_LAYOUT_INTERLEAVED  // ref/thr/stamp packed per tile, one stream per row
+};
+
+// Fields of the interleaved layout
+enum DVSTileField
+{
+    DVS_TILE_REF,
+    DVS_TILE_THR,
+    DVS_TILE_STAMP
+};
+
 class DVSOperator: public cv::ParallelLoopBody
 {
 public:
@@ -16,8 +49,27 @@ public:
                 float _relax, float _up, float _down);
     void init(cv::Mat* _src, cv::Mat* _diff, 
               cv::Mat* _ref, cv::Mat* _thr, cv::Mat* _ev,
-              const float _relax, const float _up, const float _down);
+              const float _relax, const float _up, const float _down,
+              const int _storage=DVS_STORAGE_FP32);
+    void setParams(const DVSParams& params);
+    void setBatch(const std::vector<cv::Mat>* srcs,
+                  std::vector<cv::Mat>* evs, const size_t count);
+    void setStamps(cv::Mat* _stamp);
+    void setTiles(cv::Mat* _tiles, const bool _stamps);
+    void setColor(const bool _color);
+    void setVoxel(cv::Mat* _voxel, const size_t bins, const size_t window);
+    void endFrame(const size_t frames=1);
     void operator()(const cv::Range& range) const;
+    void countRows(const cv::Range& range, cv::Vec3f* scratch,
+                   uint64_t& on, uint64_t& off) const;
+
+    static float storagePrecision(const int storage);
+    static void packState(const cv::Mat& state, cv::Mat& packed, const int storage);
+    static void unpackState(const cv::Mat& packed, cv::Mat& state, const int storage);
+    static void packTiles(const cv::Mat& ref32, const cv::Mat& thr32, cv::Mat& tiles,
+                          const int storage, const bool stamps);
+    static void unpackTiles(const cv::Mat& tiles, cv::Mat& out, const int cols,
+                            const int storage, const bool stamps, const int field);
 
 private:
     cv::Mat* src;
@@ -28,6 +80,35 @@ private:
     float relax;
     float up;
     float down;
+    float thrBase;  // base threshold the per-pixel state was built for
+    float thrScale; // one-shot rescale of the per-pixel threshold
+    int mode;
+    ushort refractory; // frames a pixel is silent after firing (needs stamps)
+
+    // Temporal blocked (multi-frame) processing
+    const std::vector<cv::Mat>* srcBatch;
+    std::vector<cv::Mat>* evBatch;
+    size_t batchSize;
+    int batchRows;
+
+    int storage;
+    cv::Mat* stamps;    // planar last fire stamps, may be null
+    cv::Mat* tiles;     // interleaved state, null for planar layout
+    bool tileStamps;
+    bool color;         // per channel state over 8-bit BGR input
+    ushort frameStamp;  // 16-bit wrapping frame counter
+
+    // Voxel grid output, bins images of the frame height stacked in voxel
+    cv::Mat* voxel;
+    size_t voxelBins;
+    size_t voxelWindow;
+    size_t voxelFrame;  // position of the current frame in the window
+    size_t stampClock;  // frames since stamps were last clamped
+
+    void clampStamps();
+    void processRow(const int row, const cv::Mat& frame,
+                    cv::Vec3f* it_ev, const float scale,
+                    const size_t k) const;
 
 };
 
@@ -0,0 +1,65 @@
+#ifndef DVS_PARAMS_HPP
+#define DVS_PARAMS_HPP
+
+#include <atomic>
+#include <stdint.h>
+
+// Which event polarities are written to the event frame
+enum DVSOutputMode
+{
+    DVS_OUTPUT_BOTH,
+    DVS_OUTPUT_ON,  // brightness increase only
+    DVS_OUTPUT_OFF  // brightness decrease only
+};
+
+// Runtime tunable emulator parameters
+struct DVSParams
+{
+    float thr;
+    float relax;
+    float up;
+    float down;
+    int mode;
+    int refractory; // frames a pixel stays silent after firing, 0 = off
+};
+
+// Single slot parameter mailbox (sequence lock). Any thread may publish,
+// the processing thread polls once per frame and never blocks: when a
+// publish is in flight the previous parameters are kept for that frame.
+class DVSParamBlock
+{
+public:
+    DVSParamBlock();
+    void publish(const DVSParams& params);
+    bool tryRead(DVSParams& params, uint32_t& version) const;
+    void read(DVSParams& params) const;
+    uint32_t version() const;
+
+    // Atomic read-modify-publish, modify(DVSParams&) edits the last
+    // published set, so concurrent updates of other fields are kept
+    template<class F>
+    void update(F modify)
+    {
+        const uint32_t seq {_lock()};
+        DVSParams params;
+        _load(params);
+        modify(params);
+        _store(params);
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+private:
+    uint32_t _lock();
+    void _load(DVSParams& params) const;
+    void _store(const DVSParams& params);
+
+    std::atomic<uint32_t> _seq;
+    std::atomic<float> _thr;
+    std::atomic<float> _relax;
+    std::atomic<float> _up;
+    std::atomic<float> _down;
+    std::atomic<int> _mode;
+    std::atomic<int> _refractory;
+};
+
+#endif // DVS_PARAMS_HPP
@@ -0,0 +1,56 @@
+#ifndef DVS_PYRAMID_HPP
+#define DVS_PYRAMID_HPP
+
+#include <iostream>
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "opencv2/core/core.hpp"
+
+#include "dvs_op.hpp"
+#include "dvs_params.hpp"
+
+// Upper bound on levels, a 2^16 pixel wide frame runs out before it
+static const int DVS_PYRAMID_MAX_LEVELS {16};
+
+// Multi-resolution emulator. Level 0 is the caller's full resolution
+// operator, every further level halves width and height. One parallel row
+// pass runs level 0, box filters the rows it just used into the next level
+// input while they are still cached, and runs that level on them.
+class DVSPyramid: public cv::ParallelLoopBody
+{
+public:
+    DVSPyramid();
+    bool init(DVSOperator* base, cv::Mat* in, const size_t levels,
+              const int storage, const float thr, const float relax,
+              const float up, const float down);
+    void setParams(const DVSParams& params);
+    void endFrame(const size_t frames=1);
+    void operator()(const cv::Range& range) const;
+
+    size_t getLevels() const;
+    int getRows() const;
+    cv::Mat& getInput(const size_t level);
+    cv::Mat& getEvents(const size_t level);
+    cv::Mat& getReference(const size_t level);
+    cv::Mat& getThreshold(const size_t level);
+
+private:
+    DVSOperator* _base;
+    cv::Mat* _baseIn;
+
+    // Levels 1..n-1, index 0 is level 1. Inputs are filled by the row pass.
+    mutable std::vector<cv::Mat> _in;
+    std::vector<cv::Mat> _ref;
+    std::vector<cv::Mat> _diff;
+    std::vector<cv::Mat> _thr;
+    std::vector<cv::Mat> _events;
+    std::vector<DVSOperator> _ops;
+    std::vector<cv::Mat> _refView;
+    std::vector<cv::Mat> _thrView;
+
+    size_t _levels;
+    int _storage;
+    int _rows; // rows of the coarsest level, unit of parallel work
+};
+
+#endif // DVS_PYRAMID_HPP
@@ -0,0 +1,62 @@
+#ifndef DVS_RAW_HPP
+#define DVS_RAW_HPP
+
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "opencv2/core/core.hpp"
+
+// Uncompressed input formats
+enum DVSRawFormat
+{
+    DVS_RAW_GRAY8,  // headerless 8-bit gray frames
+    DVS_RAW_BGR24,  // headerless 8-bit interleaved BGR frames
+    DVS_RAW_Y4M     // YUV4MPEG2 stream, 4:2:0 or mono
+};
+
+// Frame source for raw video coming from stdin ("-"), a FIFO or a file.
+// Pipes are read with large sequential read() calls straight into the
+// caller's frame buffer, regular files are memory mapped and frames alias
+// the mapping (copy-on-write), so there is no decode and no extra copy.
+// PyDVS hands gray frames to the emulator kernel as 8-bit rows; BGR frames
+// still go through a gray conversion, and a float widening pass remains
+// when pyramid levels are on.
+class DVSRawSource
+{
+public:
+    DVSRawSource();
+    ~DVSRawSource();
+    bool open(const std::string& path, const int format,
+              const size_t w=0, const size_t h=0, const size_t fps=0);
+    bool read(cv::Mat& frame);
+    void close();
+    void setColor(const bool color);
+
+    size_t getWidth() const;
+    size_t getHeight() const;
+    size_t getFPS() const;
+    int getType() const;
+    bool isOpened() const;
+
+private:
+    int _fd;
+    bool _ownFd;
+    uint8_t* _map;
+    size_t _mapSize;
+    size_t _offset;
+    int _format;
+    bool _colorY4M;     // Y4M frames converted to BGR on read
+    size_t _w, _h, _fps;
+    size_t _frameBytes; // payload bytes read into the frame
+    size_t _skipBytes;  // trailing bytes (chroma) skipped per frame
+    std::vector<uint8_t> _scratch;
+    cv::Mat _yuv;
+
+    bool _readFull(uint8_t* dst, const size_t n);
+    bool _readLine(std::string& line);
+    bool _parseY4MHeader(const std::string& header);
+};
+
+#endif // DVS_RAW_HPP
@@ -0,0 +1,64 @@
+#ifndef DVS_SWEEP_HPP
+#define DVS_SWEEP_HPP
+
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "opencv2/core/core.hpp"
+
+#include "dvs_op.hpp"
+
+// One point of the parameter grid
+struct DVSSweepConfig
+{
+    float thr;
+    float relax;
+    float up;
+    float down;
+};
+
+// Runs many independent emulator states over one shared input frame.
+// Work is scheduled by (config, row-block) so a single decode feeds
+// every configuration of the grid.
+class DVSSweep: public cv::ParallelLoopBody
+{
+public:
+    DVSSweep();
+    bool init(const std::vector<DVSSweepConfig>& configs,
+              const size_t w, const size_t h);
+    void update(const cv::Mat& in);
+    bool writeSummary(const std::string& filename) const;
+    void operator()(const cv::Range& range) const;
+
+    size_t getNumConfigs() const;
+    size_t getNumFrames() const;
+
+    static std::vector<DVSSweepConfig> grid(const std::vector<float>& thr,
+                                            const std::vector<float>& relax,
+                                            const std::vector<float>& up,
+                                            const std::vector<float>& down);
+
+private:
+    std::vector<DVSSweepConfig> _configs;
+    std::vector<cv::Mat> _ref;
+    std::vector<cv::Mat> _thr;
+    std::vector<DVSOperator> _ops;
+    cv::Mat _in;
+
+    // Event counts of the last frame, indexed [block * configs + config]
+    mutable std::vector<uint64_t> _blockOn;
+    mutable std::vector<uint64_t> _blockOff;
+
+    // Accumulated statistics, indexed by config
+    std::vector<uint64_t> _totalOn;
+    std::vector<uint64_t> _totalOff;
+    std::vector<uint64_t> _peak;
+
+    size_t _w, _h;
+    size_t _blockRows, _numBlocks;
+    size_t _frames;
+};
+
+#endif // DVS_SWEEP_HPP
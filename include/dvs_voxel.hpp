@@ -0,0 +1,58 @@
+#ifndef DVS_VOXEL_HPP
+#define DVS_VOXEL_HPP
+
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include "opencv2/opencv.hpp"
+#include "opencv2/core/core.hpp"
+
+// Time-binned event tensor (bins x H x W, float) over a window of frames.
+// The grid is a single preallocated image of bins * H rows, bin b is rows
+// [b * H, (b + 1) * H). The emulator kernel adds the signed events of every
+// row into it while the row is processed, see DVSOperator::setVoxel().
+//
+// Completed windows are appended to a memory mapped dataset file:
+//   32 byte header { char magic[8] = "DVSVOXEL"; uint32 version, bins,
+//                    height, width; uint64 count }
+//   followed by count tensors of bins * height * width float32
+// so it can be read with np.memmap(path, np.float32, offset=32). open()
+// refuses an existing non-empty file instead of overwriting its tensors.
+class DVSVoxelGrid
+{
+public:
+    DVSVoxelGrid();
+    ~DVSVoxelGrid();
+    bool open(const std::string& path, const size_t bins, const size_t window,
+              const int rows, const int cols);
+    void close();
+    void beginFrames();
+    bool endFrames(const size_t frames);
+
+    cv::Mat& getGrid();
+    size_t getBins() const;
+    size_t getWindow() const;
+    size_t getRemaining() const;
+    size_t getCount() const;
+    bool isOpened() const;
+
+private:
+    cv::Mat _grid;
+    size_t _bins;
+    size_t _window;  // frames per tensor
+    size_t _frame;   // frames accumulated in the current window
+    bool _done;      // window complete, grid is cleared on the next pass
+
+    int _fd;         // dataset file, -1 when only the grid is kept
+    uint8_t* _map;
+    size_t _mapSize;
+    size_t _capacity; // tensors the mapping holds
+    size_t _count;    // tensors written
+    size_t _tensorBytes;
+
+    bool _reserve(const size_t tensors);
+    size_t _growStep() const;
+    bool _emit();
+};
+
+#endif // DVS_VOXEL_HPP
@@ -0,0 +1,211 @@
+// Python bindings for the C++ PyDVS engine.
+// Output images are returned as NumPy arrays that alias the engine buffers
+// and are overwritten in place by later updates. Every array holds its own
+// reference on the buffer, so it stays valid after a re-init replaces the
+// engine images (it then stops tracking them). With compact storage or
+// interleaved layout, get_reference()/get_threshold() alias an unpacked
+// copy that is refreshed on every call.
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "dvs_emu.hpp"
+
+namespace py = pybind11;
+
+// NumPy dtype of an OpenCV depth
+static py::dtype matDtype(const cv::Mat& m)
+{
+    switch(m.depth())
+    {
+    case CV_8U:
+        return py::dtype::of<uint8_t>();
+    case CV_16U:
+        return py::dtype::of<uint16_t>();
+    case CV_16F:
+        return py::dtype("float16");
+    case CV_32F:
+        return py::dtype::of<float>();
+    default:
+        throw std::runtime_error("Unsupported cv::Mat depth");
+    }
+}
+
+// Array base owning a cv::Mat header, its reference count keeps the buffer
+// alive for as long as the array exists. Buffers OpenCV does not own
+// (frames aliasing a raw input mapping) are copied, they are re-pointed or
+// unmapped behind the array's back.
+static py::capsule matOwner(const cv::Mat& m)
+{
+    cv::Mat* held {new cv::Mat(m.u == nullptr ? m.clone() : m)};
+    return py::capsule(held, [](void* p) { delete static_cast<cv::Mat*>(p); });
+}
+
+// Zero-copy view of a cv::Mat
+static py::array matView(const cv::Mat& m)
+{
+    const py::capsule owner {matOwner(m)};
+    const cv::Mat& held {*static_cast<cv::Mat*>(owner.get_pointer())};
+    std::vector<py::ssize_t> shape {held.rows, held.cols};
+    std::vector<py::ssize_t> strides {static_cast<py::ssize_t>(held.step[0]),
+                                      static_cast<py::ssize_t>(held.elemSize())};
+    if(held.channels() > 1)
+    {
+        shape.push_back(held.channels());
+        strides.push_back(static_cast<py::ssize_t>(held.elemSize1()));
+    }
+    return py::array(matDtype(held), shape, strides, held.data, owner);
+}
+
+// cv::Mat header over a C-contiguous uint8/float32 array, no copy
+static cv::Mat arrayMat(const py::array& a)
+{
+    if(!(a.flags() & py::array::c_style) || (a.ndim() != 2 && a.ndim() != 3))
+    {
+        throw std::invalid_argument("Expected a C-contiguous HxW or HxWx3 array");
+    }
+
+    const int channels {a.ndim() == 3 ? static_cast<int>(a.shape(2)) : 1};
+    int depth {CV_8U};
+    if(py::isinstance<py::array_t<float>>(a))
+    {
+        depth = CV_32F;
+    }
+    else if(!py::isinstance<py::array_t<uint8_t>>(a))
+    {
+        throw std::invalid_argument("Expected a uint8 or float32 array");
+    }
+
+    return cv::Mat(static_cast<int>(a.shape(0)), static_cast<int>(a.shape(1)),
+                   CV_MAKETYPE(depth, channels), const_cast<void*>(a.data()));
+}
+
+PYBIND11_MODULE(pydvs_cpp, m)
+{
+    m.doc() = "C++ pyDVS emulator";
+
+    m.attr("OUTPUT_BOTH") = static_cast<int>(DVS_OUTPUT_BOTH);
+    m.attr("OUTPUT_ON") = static_cast<int>(DVS_OUTPUT_ON);
+    m.attr("OUTPUT_OFF") = static_cast<int>(DVS_OUTPUT_OFF);
+    m.attr("STORAGE_FP32") = static_cast<int>(DVS_STORAGE_FP32);
+    m.attr("STORAGE_FP16") = static_cast<int>(DVS_STORAGE_FP16);
+    m.attr("STORAGE_BF16") = static_cast<int>(DVS_STORAGE_BF16);
+    m.attr("LAYOUT_PLANAR") = static_cast<int>(DVS_LAYOUT_PLANAR);
+    m.attr("LAYOUT_INTERLEAVED") = static_cast<int>(DVS_LAYOUT_INTERLEAVED);
+
+    py::class_<PyDVS>(m, "PyDVS")
+        .def(py::init<>())
+        .def("init", [](PyDVS& self, const std::string& source, float thr,
+                        float relaxRate, float adaptUp, float adaptDown)
+             {
+                 return self.init(source, thr, relaxRate, adaptUp, adaptDown);
+             },
+             py::arg("source"), py::arg("thr")=12.75f, py::arg("relax_rate")=1.0f,
+             py::arg("adapt_up")=1.0f, py::arg("adapt_down")=1.0f)
+        .def("init", [](PyDVS& self, int camId, float thr,
+                        float relaxRate, float adaptUp, float adaptDown)
+             {
+                 return self.init(camId, thr, relaxRate, adaptUp, adaptDown);
+             },
+             py::arg("cam_id"), py::arg("thr")=12.75f, py::arg("relax_rate")=1.0f,
+             py::arg("adapt_up")=1.0f, py::arg("adapt_down")=1.0f)
+        .def("init_frames", [](PyDVS& self, int width, int height, float thr,
+                               float relaxRate, float adaptUp, float adaptDown)
+             {
+                 return self.init(cv::Size(width, height), thr, relaxRate,
+                                  adaptUp, adaptDown);
+             },
+             py::arg("width"), py::arg("height"), py::arg("thr")=12.75f,
+             py::arg("relax_rate")=1.0f, py::arg("adapt_up")=1.0f,
+             py::arg("adapt_down")=1.0f)
+        .def("update", &PyDVS::update, py::call_guard<py::gil_scoped_release>())
+        .def("process", [](PyDVS& self, const py::array& frame)
+             {
+                 // Header only, the array buffer is read in place
+                 const cv::Mat in {arrayMat(frame)};
+                 py::gil_scoped_release release;
+                 return self.process(in);
+             },
+             py::arg("frame"))
+        .def("set_adapt", &PyDVS::setAdapt, py::arg("relax_rate"),
+             py::arg("adapt_up"), py::arg("adapt_down"), py::arg("threshold"))
+        .def("set_output_mode", &PyDVS::setOutputMode)
+        .def("set_storage", &PyDVS::setStorage)
+        .def("set_layout", &PyDVS::setLayout)
+        .def("set_refractory", &PyDVS::setRefractory, py::arg("frames"))
+        .def("set_voxel_grid", &PyDVS::setVoxelGrid, py::arg("path"), py::arg("bins"),
+             py::arg("frames"), py::arg("ms")=0.0f)
+        .def("publish", [](PyDVS& self, float thr, float relaxRate, float adaptUp,
+                           float adaptDown, std::optional<int> mode,
+                           std::optional<int> refractory)
+             {
+                 // Safe to call from another thread while update() runs.
+                 // Omitted mode/refractory keep their current values.
+                 self.getParamBlock().update([&](DVSParams& p)
+                 {
+                     p.thr = thr;
+                     p.relax = relaxRate;
+                     p.up = adaptUp;
+                     p.down = adaptDown;
+                     if(mode)
+                     {
+                         p.mode = *mode;
+                     }
+                     if(refractory)
+                     {
+                         p.refractory = *refractory;
+                     }
+                 });
+             },
+             py::arg("thr"), py::arg("relax_rate"), py::arg("adapt_up"),
+             py::arg("adapt_down"), py::arg("mode")=py::none(),
+             py::arg("refractory")=py::none())
+        .def_property_readonly("width", &PyDVS::getWidth)
+        .def_property_readonly("height", &PyDVS::getHeight)
+        .def_property_readonly("fps", &PyDVS::getFPS)
+        .def_property_readonly("voxel_ready", &PyDVS::isVoxelReady)
+        .def_property_readonly("voxel_count", &PyDVS::getVoxelCount)
+        .def("get_input", [](PyDVS& self)
+             {
+                 return matView(self.getInput());
+             })
+        .def("get_events", [](PyDVS& self)
+             {
+                 return matView(self.getEvents());
+             })
+        .def("get_difference", [](PyDVS& self)
+             {
+                 return matView(self.getDifference());
+             })
+        .def("get_reference", [](PyDVS& self)
+             {
+                 return matView(self.getReference());
+             })
+        .def("get_threshold", [](PyDVS& self)
+             {
+                 return matView(self.getThreshold());
+             })
+        .def("get_voxel_grid", [](PyDVS& self)
+             {
+                 // (bins, H, W) view of the stacked grid image
+                 const py::ssize_t bins {static_cast<py::ssize_t>(self.getVoxelBins())};
+                 if(bins == 0 || self.getVoxelGrid().empty())
+                 {
+                     throw std::runtime_error("Voxel grid is not enabled");
+                 }
+                 const py::capsule owner {matOwner(self.getVoxelGrid())};
+                 const cv::Mat& grid {*static_cast<cv::Mat*>(owner.get_pointer())};
+                 const py::ssize_t rows {grid.rows / bins};
+                 const py::ssize_t step {static_cast<py::ssize_t>(grid.step[0])};
+                 return py::array(py::dtype::of<float>(),
+                                  {bins, rows, static_cast<py::ssize_t>(grid.cols)},
+                                  {rows * step, step, static_cast<py::ssize_t>(sizeof(float))},
+                                  grid.data, owner);
+             });
+}
@@ -1,18 +1,33 @@
 #include "dvs_emu.hpp"
 
+#include <cmath>
+#include <limits>
+
 // Constructor
 PyDVS::PyDVS()
     : _relaxRate(1.0f), _adaptUp(1.0f), _adaptDown(1.0f),
-      _baseThresh(12.0f), _w(0), _h(0), _fps(0), _open(false)
+      _baseThresh(12.0f), _outputMode(DVS_OUTPUT_BOTH),
+      _storage(DVS_STORAGE_FP32), _layout(DVS_LAYOUT_PLANAR), _stamps(false),
+      _color(false), _levels(1), _refractory(0),
+      _voxelBins(0), _voxelFrames(0), _voxelMs(0.0f), _voxelReady(false),
+      _paramsVersion(0), _w(0), _h(0), _fps(0), _open(false), _is_vid(false),
+      _is_raw(false)
 {
-
+    _publishParams();
 }
 
 PyDVS::PyDVS(size_t w, size_t h, size_t fps)
+    : _relaxRate(1.0f), _adaptUp(1.0f), _adaptDown(1.0f),
+      _baseThresh(12.0f), _outputMode(DVS_OUTPUT_BOTH),
+      _storage(DVS_STORAGE_FP32), _layout(DVS_LAYOUT_PLANAR), _stamps(false),
+      _color(false), _levels(1), _refractory(0),
+      _voxelBins(0), _voxelFrames(0), _voxelMs(0.0f), _voxelReady(false),
+      _paramsVersion(0), _open(false), _is_vid(false), _is_raw(false)
 {
     _w = w;
     _h = h;
     _fps = fps;
+    _publishParams();
 }
 
 // Destructor
@@ -21,6 +36,7 @@ PyDVS::~PyDVS()
     if(_open)
     {
         _cap.release();
+        _raw.close();
     }
 }
 
@@ -42,6 +58,7 @@ bool PyDVS::init(const int cam_id, const float thr, const float relaxRate,
     
     bool success{true};
     _is_vid = false;
+    _is_raw = false;
     if(_w == 0 || _h == 0 || _fps == 0)
     {
         _get_size();
@@ -53,9 +70,6 @@ bool PyDVS::init(const int cam_id, const float thr, const float relaxRate,
         success &= _set_fps();
     }
 
-    // set output format as 32-bit floating point with a single channel
-    _cap.set(cv::CAP_PROP_FORMAT, CV_32FC3);
-
     setAdapt(relaxRate, adaptUp, adaptDown, thr);
     _initMatrices(thr);
 
@@ -78,12 +92,10 @@ bool PyDVS::init(const std::string& filename, const float thr, const float relax
     }
 
     _is_vid = true;
+    _is_raw = false;
     _get_size();
     _get_fps();
 
-    // set output format as 32-bit floating point with a single channel
-    _cap.set(cv::CAP_PROP_FORMAT, CV_32FC3);
-
     setAdapt(relaxRate, adaptUp, adaptDown, thr);
     _initMatrices(thr);
 
@@ -106,11 +118,63 @@ bool PyDVS::init(const char* filename, const float thr, const float relaxRate,
     }
 
     _is_vid = true;
+    _is_raw = false;
     _get_size();
     _get_fps();
 
-    // set output format as 32-bit floating point with a BGR channel
-    _cap.set(cv::CAP_PROP_FORMAT, CV_32FC3);
+    setAdapt(relaxRate, adaptUp, adaptDown, thr);
+    _initMatrices(thr);
+
+    return true;
+}
+
+// Init for raw frames (DVSRawFormat) read from stdin ("-"), a FIFO or a file.
+// Headerless formats take their size and fps from setWidth/Height/FPS.
+bool PyDVS::initRaw(const std::string& path, const int format, const float thr,
+                    const float relaxRate, const float adaptUp, const float adaptDown)
+{
+    _raw.setColor(_color);
+    _open = _raw.open(path, format, _w, _h, _fps);
+    if(!_open)
+    {
+        std::cerr << "Init. Cannot open raw input!\n";
+        return false;
+    }
+
+    if(_color && _raw.getType() != CV_8UC3)
+    {
+        std::cerr << "Init. Color mode needs bgr24 or 4:2:0 y4m raw input!\n";
+        _raw.close();
+        _open = false;
+        return false;
+    }
+
+    _is_raw = true;
+    _is_vid = false;
+    _w = _raw.getWidth();
+    _h = _raw.getHeight();
+    _fps = _raw.getFPS();
+
+    setAdapt(relaxRate, adaptUp, adaptDown, thr);
+    _initMatrices(thr);
+
+    return true;
+}
+
+// Init for frames pushed through process(), no capture device is opened
+bool PyDVS::init(const cv::Size& size, const float thr, const float relaxRate, 
+                 const float adaptUp, const float adaptDown)
+{
+    if(size.width <= 0 || size.height <= 0)
+    {
+        std::cerr << "Init. Invalid frame size!\n";
+        return false;
+    }
+
+    _is_vid = false;
+    _is_raw = false;
+    _w = size.width;
+    _h = size.height;
 
     setAdapt(relaxRate, adaptUp, adaptDown, thr);
     _initMatrices(thr);
@@ -123,25 +187,148 @@ void PyDVS::_initMatrices(const float thr_init)
     // 32-bit floating point numbers
     _frame = cv::Mat::zeros(_h, _w, CV_32FC3);
     _gray  = cv::Mat::zeros(_h, _w, CV_8UC1);
-    _in  = cv::Mat::zeros(_h, _w, CV_32F);
-    _ref = cv::Mat::zeros(_h, _w, CV_32F);
+    _in  = cv::Mat::zeros(_h, _w, _inputType());
     _diff = cv::Mat::zeros(_h, _w, CV_32F);
     _events = cv::Mat::zeros(_h, _w, CV_32FC3);
 
+    // State is built for the last published parameters
+    DVSParams params;
+    _params.read(params);
+    _mirrorParams(params);
+
     std::cout << _relaxRate << "," << _adaptUp << "," << _adaptDown << '\n';
     if(thr_init > _baseThresh)
     {
         _baseThresh = thr_init;
     }
-    _thr = _baseThresh * cv::Mat::ones(_h, _w, CV_32F);
+
+    // ref/thr may be kept in a compact format, see setStorage(), and
+    // packed per tile, see setLayout(). Color keeps B, G, R planes per row.
+    const int stateCols {static_cast<int>(_color ? 3 * _w : _w)};
+    const cv::Mat ref32 {cv::Mat::zeros(_h, stateCols, CV_32F)};
+    const cv::Mat thr32 {_baseThresh * cv::Mat::ones(_h, stateCols, CV_32F)};
+    _stamp.release();
+    _tiles.release();
+    if(_layout == DVS_LAYOUT_INTERLEAVED && !_color)
+    {
+        DVSOperator::packTiles(ref32, thr32, _tiles, _storage, _stamps);
+        _ref.release();
+        _thr.release();
+    }
+    else
+    {
+        DVSOperator::packState(ref32, _ref, _storage);
+        DVSOperator::packState(thr32, _thr, _storage);
+        if(_stamps && !_color)
+        {
+            _stamp = cv::Mat::zeros(_h, _w, CV_16U);
+        }
+    }
     _dvsOp.init(&_in, &_diff, &_ref, &_thr, &_events,
-                _relaxRate, _adaptUp, _adaptDown);
+                _relaxRate, _adaptUp, _adaptDown, _storage);
+    _dvsOp.setStamps(_stamp.empty() ? nullptr : &_stamp);
+    _dvsOp.setTiles(_tiles.empty() ? nullptr : &_tiles, _stamps);
+    _dvsOp.setColor(_color);
+
+    // Lower pyramid levels are built from the float gray input
+    if(_levels > 1 && (_color || !_pyramid.init(&_dvsOp, &_in, _levels, _storage,
+                                                _baseThresh, _relaxRate,
+                                                _adaptUp, _adaptDown)))
+    {
+        std::cerr << "Init. Pyramid disabled, it needs gray input and enough resolution\n";
+        _levels = 1;
+    }
+
+    // Voxel grid output, accumulated by the level 0 kernel
+    _voxelReady = false;
+    if(_voxelBins > 0)
+    {
+        size_t window {_voxelFrames};
+        if(_voxelMs > 0.0f && _fps > 0)
+        {
+            window = std::max<size_t>(1, static_cast<size_t>(_voxelMs * _fps / 1000.0f + 0.5f));
+        }
+        if(_color || !_voxel.open(_voxelPath, _voxelBins, window, _h, _w))
+        {
+            std::cerr << "Init. Voxel grid disabled, it needs gray input and a valid window\n";
+            _voxel.close();
+            _voxelBins = 0;
+        }
+        else
+        {
+            _dvsOp.setVoxel(&_voxel.getGrid(), _voxelBins, window);
+        }
+    }
+
+    // Odd version, never a stable sequence: the next frame applies the
+    // current parameter block to the fresh operators
+    _paramsVersion = 1u;
 
 }
 
-// Update frames from camera stream method
-bool PyDVS::update()
+// Emulator input type: BGR in color mode, raw gray frames as they are read
+// (the kernels widen 8-bit rows in registers), float gray otherwise. The
+// pyramid builds its levels from float input.
+int PyDVS::_inputType() const
+{
+    if (_color)
+    {
+        return CV_8UC3;
+    }
+    return _is_raw && _levels == 1 ? CV_8UC1 : CV_32F;
+}
+
+// Decode the next frame and convert it into in
+bool PyDVS::_grab(cv::Mat& in)
 {
+    // Color mode runs on the decoded BGR frame as is
+    if (_color)
+    {
+        if (_is_raw)
+        {
+            if (!_raw.read(in))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            _cap >> in;
+        }
+        _frame = in;
+        return !in.empty();
+    }
+
+    // Raw input, no decode. 8-bit gray frames are read (or aliased) into an
+    // 8-bit in and go to the kernel without conversion; BGR frames still
+    // need the gray conversion, and float input (pyramid) a widening pass.
+    if (_is_raw)
+    {
+        cv::Mat& gray {in.type() == CV_8UC1 ? in : _gray};
+        if (_raw.getType() == CV_8UC1)
+        {
+            if (!_raw.read(gray))
+            {
+                return false;
+            }
+            _frame = gray;
+        }
+        else
+        {
+            _frame.create(_h, _w, CV_8UC3);
+            if (!_raw.read(_frame))
+            {
+                return false;
+            }
+            cv::cvtColor(_frame, gray, cv::COLOR_BGR2GRAY);
+        }
+        if (&gray != &in)
+        {
+            gray.convertTo(in, CV_32F);
+        }
+        return true;
+    }
+
     _cap >> _frame;
     if (_frame.empty())
     {
@@ -149,12 +336,203 @@ bool PyDVS::update()
     }
 
     cv::cvtColor(_frame, _gray, cv::COLOR_BGR2GRAY);
-    _gray.convertTo(_in, CV_32F);
-    cv::parallel_for_(cv::Range(0, _gray.rows), _dvsOp);
+    _gray.convertTo(in, CV_32F);
+
+    return true;
+}
+
+// Read and convert the next frame without running the emulator
+bool PyDVS::read()
+{
+    return _grab(_in);
+}
+
+// Update frames from camera stream method
+bool PyDVS::update()
+{
+    if (!read())
+    {
+        return false;
+    }
+
+    _run();
     
     return true;
 }
 
+// Run the emulator on an external frame: 8-bit BGR, 8-bit gray or 32-bit
+// float gray, with the size given at init
+bool PyDVS::process(const cv::Mat& frame)
+{
+    if(frame.rows != static_cast<int>(_h) || frame.cols != static_cast<int>(_w))
+    {
+        std::cerr << "Process. Frame size does not match init size!\n";
+        return false;
+    }
+
+    if(_color)
+    {
+        if(frame.type() != CV_8UC3)
+        {
+            std::cerr << "Process. Color mode expects 8-bit BGR frames!\n";
+            return false;
+        }
+        frame.copyTo(_in);
+    }
+    else if(frame.type() == CV_8UC3)
+    {
+        if(_in.type() == CV_8UC1)
+        {
+            cv::cvtColor(frame, _in, cv::COLOR_BGR2GRAY);
+        }
+        else
+        {
+            cv::cvtColor(frame, _gray, cv::COLOR_BGR2GRAY);
+            _gray.convertTo(_in, CV_32F);
+        }
+    }
+    else if(frame.type() == CV_8UC1)
+    {
+        frame.convertTo(_in, _in.type() == CV_8UC1 ? CV_8U : CV_32F);
+    }
+    else if(frame.type() == CV_32FC1)
+    {
+        frame.copyTo(_in);
+    }
+    else
+    {
+        std::cerr << "Process. Unsupported frame type!\n";
+        return false;
+    }
+
+    _run();
+
+    return true;
+}
+
+// Emulator pass over _in
+void PyDVS::_run()
+{
+    _pollParams();
+    if(_voxelBins > 0)
+    {
+        _voxel.beginFrames();
+    }
+    if(_levels > 1)
+    {
+        // One fused pass over every level, split on rows of the coarsest
+        cv::parallel_for_(cv::Range(0, _pyramid.getRows()), _pyramid);
+        _pyramid.endFrame();
+    }
+    else
+    {
+        cv::parallel_for_(cv::Range(0, static_cast<int>(_h)), _dvsOp);
+    }
+    _dvsOp.endFrame();
+    _voxelReady = _voxelBins > 0 && _voxel.endFrames(1);
+}
+
+// Offline update over up to k frames at once, returns the number of frames
+// processed. Events of frame i are in getEventsBatch()[i]. With the voxel
+// grid on, a batch stops at the end of the current window. Not available
+// with pyramid levels, the lower levels would fall behind level 0.
+size_t PyDVS::updateBatch(const size_t k)
+{
+    if (_levels > 1)
+    {
+        std::cerr << "Batch. Not supported with pyramid levels, use update()!\n";
+        return 0;
+    }
+
+    // Buffers follow the current frame size and input type (a re-init may
+    // change both), create() only reallocates the ones that differ
+    _inBatch.resize(k);
+    _eventsBatch.resize(k);
+    for (size_t i{0}; i < k; ++i)
+    {
+        _inBatch[i].create(_h, _w, _inputType());
+        _eventsBatch[i].create(_h, _w, CV_32FC3);
+    }
+
+    const size_t limit {_voxelBins > 0 ? std::min(k, _voxel.getRemaining()) : k};
+    size_t n {0};
+    while (n < limit && _grab(_inBatch[n]))
+    {
+        ++n;
+    }
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    _pollParams();
+    if (_voxelBins > 0)
+    {
+        _voxel.beginFrames();
+    }
+    _dvsOp.setBatch(&_inBatch, &_eventsBatch, n);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(_h)), _dvsOp);
+    _dvsOp.setBatch(nullptr, nullptr, 0);
+    _dvsOp.endFrame(n);
+    _voxelReady = _voxelBins > 0 && _voxel.endFrames(n);
+
+    return n;
+}
+
+// Frame boundary, pick up parameters published since the last frame
+void PyDVS::_pollParams()
+{
+    DVSParams params;
+    if(_params.tryRead(params, _paramsVersion))
+    {
+        _dvsOp.setParams(params);
+        if(_levels > 1)
+        {
+            _pyramid.setParams(params);
+        }
+        _mirrorParams(params);
+    }
+}
+
+// Processing thread copy of the runtime parameters, only written here
+void PyDVS::_mirrorParams(const DVSParams& params)
+{
+    _baseThresh = params.thr;
+    _relaxRate = params.relax;
+    _adaptUp = params.up;
+    _adaptDown = params.down;
+    _outputMode = params.mode;
+    _refractory = static_cast<size_t>(std::max(params.refractory, 0));
+
+    // Compact state silently drops multiplicative steps too close to 1
+    const float eps {DVSOperator::storagePrecision(_storage)};
+    const float rates[3] {params.relax, params.up, params.down};
+    const char* names[3] {"relax rate", "adapt up", "adapt down"};
+    for(int i{0}; i < 3; ++i)
+    {
+        if(rates[i] != 1.0f && std::fabs(1.0f - rates[i]) < eps)
+        {
+            std::cerr << "Warning. " << names[i] << ' ' << rates[i]
+                      << " is within " << eps << " of 1, the "
+                      << (_storage == DVS_STORAGE_BF16 ? "bf16" : "fp16")
+                      << " state rounds it away, use fp32 storage\n";
+        }
+    }
+}
+
+// Seed the parameter block from the members, constructors only
+void PyDVS::_publishParams()
+{
+    DVSParams params;
+    params.thr = _baseThresh;
+    params.relax = _relaxRate;
+    params.up = _adaptUp;
+    params.down = _adaptDown;
+    params.mode = _outputMode;
+    params.refractory = static_cast<int>(_refractory);
+    _params.publish(params);
+}
+
 // Set parameter methods
 bool PyDVS::_set_size()
 {
@@ -212,28 +590,112 @@ void PyDVS::setHeight(const size_t h)
     _h = h;
 }
 
+// Runtime parameter setters (relax rate, adaptation, threshold, output mode,
+// refractory period) only edit the published parameter block, so they are
+// safe to call from a control thread while update() runs. The processing
+// thread applies them on its next frame; the matching getters return the
+// last value set.
 void PyDVS::setRelaxRate(const float r)
 {
-    _relaxRate = r;
+    _params.update([r](DVSParams& p) { p.relax = r; });
 }
 
 void PyDVS::setAdaptUp(const float u)
 {
-    _adaptUp = u;
+    _params.update([u](DVSParams& p) { p.up = u; });
 }
 
 void PyDVS::setAdaptDown(const float d)
 {
-    _adaptDown = d;
+    _params.update([d](DVSParams& p) { p.down = d; });
+}
+
+// Storage format of the ref/thr state (DVSStorage), takes effect on init.
+// FP16/BF16 halve the state traffic, the difference image is then not kept.
+// Their precision is limited: relax/adapt rates within
+// DVSOperator::storagePrecision() of 1 stop changing the state, a warning
+// is printed when such rates are applied.
+void PyDVS::setStorage(const int storage)
+{
+    _storage = storage;
+}
+
+// State layout (DVSLayout), takes effect on init. The interleaved layout
+// keeps ref/thr in one stream, getReference()/getThreshold() then unpack it.
+void PyDVS::setLayout(const int layout)
+{
+    _layout = layout;
+}
+
+// Track the 16-bit frame stamp of the last event of every pixel, takes
+// effect on init
+void PyDVS::setStamps(const bool stamps)
+{
+    _stamps = stamps;
+}
+
+// Color mode, takes effect on init. Keeps ref/thr per B, G and R channel
+// (planar layout only) and writes per channel polarity (+1/-1) to the
+// matching channel of the event frame.
+void PyDVS::setColor(const bool color)
+{
+    _color = color;
+}
+
+// Number of event pyramid levels including full resolution (1 = off), takes
+// effect on init. Level l halves the frame size l times and keeps its own
+// state; levels are served by update()/process(), not updateBatch().
+void PyDVS::setPyramid(const size_t levels)
+{
+    _levels = std::max<size_t>(1, levels);
+}
+
+// Refractory period in frames (0 = off): a pixel that fired stays silent
+// for that many frames. Needs the last fire stamps, so a non-zero period
+// also turns setStamps() on (takes effect on init, call it before init);
+// the period itself can change at any time. Not applied in color mode nor
+// to pyramid levels > 0.
+void PyDVS::setRefractory(const size_t frames)
+{
+    if(frames > 0)
+    {
+        _stamps = true;
+    }
+    const int period {static_cast<int>(std::min<size_t>(frames, std::numeric_limits<int>::max()))};
+    _params.update([period](DVSParams& p) { p.refractory = period; });
+}
+
+// Voxel grid output (bins x H x W, float), takes effect on init. Signed
+// events of every window of frames frames (or ms milliseconds at the
+// source frame rate, when ms > 0 and the rate is known) are accumulated
+// with bilinear temporal weights, see DVSOperator::setVoxel(). Finished
+// windows are appended to the dataset file path (none when empty), see
+// DVSVoxelGrid; init fails to enable it when path is an existing non-empty
+// file, re-init with a new path. bins = 0 turns it off. Gray input only.
+void PyDVS::setVoxelGrid(const std::string& path, const size_t bins,
+                         const size_t frames, const float ms)
+{
+    _voxelPath = path;
+    _voxelBins = bins;
+    _voxelFrames = frames;
+    _voxelMs = ms;
+}
+
+void PyDVS::setOutputMode(const int mode)
+{
+    _params.update([mode](DVSParams& p) { p.mode = mode; });
 }
 
 void PyDVS::setAdapt(const float relaxRate, const float adaptUp, 
                      const float adaptDown, const float threshold)
 {
-    _relaxRate = relaxRate;
-    _adaptUp = adaptUp;
-    _adaptDown = adaptDown;
-    _baseThresh = threshold;
+    _params.update([&](DVSParams& p)
+    {
+        p.relax = relaxRate;
+        p.up = adaptUp;
+        p.down = adaptDown;
+        p.thr = threshold;
+    });
 }
 
 // Get parameter methods
@@ -271,17 +733,81 @@ size_t PyDVS::getHeight()
 
 float PyDVS::getRelaxRate()
 {
-    return _relaxRate;
+    DVSParams params;
+    _params.read(params);
+    return params.relax;
 }
 
 float PyDVS::getAdaptUp()
 {
-    return _adaptUp;
+    DVSParams params;
+    _params.read(params);
+    return params.up;
 }
 
 float PyDVS::getAdaptDown()
 {
-    return _adaptDown;
+    DVSParams params;
+    _params.read(params);
+    return params.down;
+}
+
+int PyDVS::getOutputMode()
+{
+    DVSParams params;
+    _params.read(params);
+    return params.mode;
+}
+
+int PyDVS::getStorage()
+{
+    return _storage;
+}
+
+int PyDVS::getLayout()
+{
+    return _layout;
+}
+
+bool PyDVS::getColor()
+{
+    return _color;
+}
+
+size_t PyDVS::getLevels()
+{
+    return _levels;
+}
+
+size_t PyDVS::getRefractory()
+{
+    DVSParams params;
+    _params.read(params);
+    return static_cast<size_t>(std::max(params.refractory, 0));
+}
+
+size_t PyDVS::getVoxelBins()
+{
+    return _voxelBins;
+}
+
+// Windows written to the voxel dataset file so far
+size_t PyDVS::getVoxelCount()
+{
+    return _voxel.getCount();
+}
+
+// True when the last update completed a voxel grid window, getVoxelGrid()
+// then holds it until the next update
+bool PyDVS::isVoxelReady()
+{
+    return _voxelReady;
+}
+
+// Thread safe handle for retuning a running stream
+DVSParamBlock& PyDVS::getParamBlock()
+{
+    return _params;
 }
 
 cv::Mat& PyDVS::getRaw()
@@ -296,6 +822,16 @@ cv::Mat& PyDVS::getInput()
 
 cv::Mat& PyDVS::getReference()
 {
+    if(!_tiles.empty())
+    {
+        DVSOperator::unpackTiles(_tiles, _refView, _w, _storage, _stamps, DVS_TILE_REF);
+        return _refView;
+    }
+    if(_storage != DVS_STORAGE_FP32)
+    {
+        DVSOperator::unpackState(_ref, _refView, _storage);
+        return _refView;
+    }
     return _ref;
 }
 
@@ -311,5 +847,65 @@ cv::Mat& PyDVS::getEvents()
 
 cv::Mat& PyDVS::getThreshold()
 {
+    if(!_tiles.empty())
+    {
+        DVSOperator::unpackTiles(_tiles, _thrView, _w, _storage, _stamps, DVS_TILE_THR);
+        return _thrView;
+    }
+    if(_storage != DVS_STORAGE_FP32)
+    {
+        DVSOperator::unpackState(_thr, _thrView, _storage);
+        return _thrView;
+    }
     return _thr;
+}
+
+// Frame stamp of the last event per pixel (CV_16U), empty when not tracked.
+// Stamps older than 32767 frames are periodically clamped to that age.
+cv::Mat& PyDVS::getStamps()
+{
+    if(!_tiles.empty() && _stamps)
+    {
+        DVSOperator::unpackTiles(_tiles, _stampView, _w, _storage, _stamps, DVS_TILE_STAMP);
+        return _stampView;
+    }
+    return _stamp;
+}
+
+// Voxel grid being accumulated, bins images of the frame height stacked
+// vertically (bins * H x W, CV_32F)
+cv::Mat& PyDVS::getVoxelGrid()
+{
+    return _voxel.getGrid();
+}
+
+std::vector<cv::Mat>& PyDVS::getInputBatch()
+{
+    return _inBatch;
+}
+
+std::vector<cv::Mat>& PyDVS::getEventsBatch()
+{
+    return _eventsBatch;
+}
+
+// Pyramid level getters, level 0 is full resolution
+cv::Mat& PyDVS::getInput(const size_t level)
+{
+    return level == 0 ? _in : _pyramid.getInput(level);
+}
+
+cv::Mat& PyDVS::getEvents(const size_t level)
+{
+    return level == 0 ? _events : _pyramid.getEvents(level);
+}
+
+cv::Mat& PyDVS::getReference(const size_t level)
+{
+    return level == 0 ? getReference() : _pyramid.getReference(level);
+}
+
+cv::Mat& PyDVS::getThreshold(const size_t level)
+{
+    return level == 0 ? getThreshold() : _pyramid.getThreshold(level);
 }
\ No newline at end of file
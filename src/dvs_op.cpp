@@ -1,9 +1,544 @@
 #include "dvs_op.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include "opencv2/core/hal/intrin.hpp"
+
+// Target size of the per-pixel state kept hot while a batch is processed
+static const size_t BATCH_BLOCK_BYTES {256 * 1024};
+
+// Stamp ages are taken modulo 2^16. Every DVS_STAMP_CLAMP_FRAMES frames,
+// stamps older than DVS_REFRACTORY_MAX are pulled up to exactly that age,
+// so ages stay below 2^16 and an old stamp never wraps into looking fresh.
+// Frame stamps start half the range ahead of the zeroed stamp images, so
+// no pixel looks refractory before its first event either. Periods are
+// capped below DVS_REFRACTORY_MAX.
+static const ushort DVS_STAMP_START {0x8000};
+static const int DVS_REFRACTORY_MAX {0x7FFF};
+static const size_t DVS_STAMP_CLAMP_FRAMES {0x4000};
+
+// Half precision element type, renamed in OpenCV 4.9
+#if (CV_VERSION_MAJOR > 4) || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 9)
+typedef cv::hfloat dvs_half;
+#else
+typedef cv::float16_t dvs_half;
+#endif
+
+namespace
+{
+
+// Constants of one kernel pass
+struct RowParams
+{
+    float relax;
+    float up;
+    float down;
+    float scale;
+    bool on;  // emit events for diff > thr (blue)
+    bool off; // emit events for diff < -thr (red)
+    ushort stamp; // frame stamp written to pixels that fire
+    uint32_t window; // refractory period in frames, 0 = off
+    float w0; // voxel grid weight of the frame for its lower bin
+    float w1; // and for the next bin
+};
+
+// Storage policies for the ref/thr state
+struct StateF32
+{
+    typedef float T;
+    static float get(const T* p) { return *p; }
+    static void set(T* p, const float v) { *p = v; }
+#if CV_SIMD
+    static cv::v_float32 load(const T* p) { return cv::vx_load(p); }
+    static void store(T* p, const cv::v_float32& v) { cv::v_store(p, v); }
+#endif
+};
+
+struct StateF16
+{
+    typedef dvs_half T;
+    static float get(const T* p) { return static_cast<float>(*p); }
+    static void set(T* p, const float v) { *p = T(v); }
+#if CV_SIMD
+    static cv::v_float32 load(const T* p) { return cv::vx_load_expand(p); }
+    static void store(T* p, const cv::v_float32& v) { cv::v_pack_store(p, v); }
+#endif
+};
+
+// bfloat16, upper half of a float with round to nearest even
+struct StateBF16
+{
+    typedef ushort T;
+    static float get(const T* p)
+    {
+        const uint32_t bits {static_cast<uint32_t>(*p) << 16};
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    static void set(T* p, const float v)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        bits += 0x7FFFu + ((bits >> 16) & 1u);
+        *p = static_cast<T>(bits >> 16);
+    }
+#if CV_SIMD
+    static cv::v_float32 load(const T* p)
+    {
+        return cv::v_reinterpret_as_f32(cv::v_shl<16>(cv::vx_load_expand(p)));
+    }
+    static void store(T* p, const cv::v_float32& v)
+    {
+        cv::v_uint32 bits {cv::v_reinterpret_as_u32(v)};
+        bits = bits + cv::vx_setall_u32(0x7FFFu) +
+               (cv::v_shr<16>(bits) & cv::vx_setall_u32(1u));
+        cv::v_pack_store(p, cv::v_shr<16>(bits));
+    }
+#endif
+};
+
+#if CV_SIMD
+// Kernel constants broadcast to vector registers
+struct VecParams
+{
+    explicit VecParams(const RowParams& p)
+        : zero(cv::vx_setzero_f32()), relax(cv::vx_setall_f32(p.relax)),
+          up(cv::vx_setall_f32(p.up)), down(cv::vx_setall_f32(p.down)),
+          scale(cv::vx_setall_f32(p.scale)),
+          on(cv::vx_setall_f32(p.on ? 1.0f : 0.0f)),
+          off(cv::vx_setall_f32(p.off ? 1.0f : 0.0f)),
+          stamp(cv::vx_setall_u32(p.stamp)),
+          window(cv::vx_setall_u32(p.window)),
+          mask16(cv::vx_setall_u32(0xFFFF)),
+          all(cv::v_reinterpret_as_f32(cv::vx_setall_u32(0xFFFFFFFF))),
+          w0(cv::vx_setall_f32(p.w0)), w1(cv::vx_setall_f32(p.w1))
+    {
+
+    }
+
+    cv::v_float32 zero;
+    cv::v_float32 relax;
+    cv::v_float32 up;
+    cv::v_float32 down;
+    cv::v_float32 scale;
+    cv::v_float32 on;
+    cv::v_float32 off;
+    cv::v_uint32 stamp;
+    cv::v_uint32 window;
+    cv::v_uint32 mask16;
+    cv::v_float32 all;
+    cv::v_float32 w0;
+    cv::v_float32 w1;
+};
+
+// One vector of pixels: updates ref/thr in place and returns the masked
+// difference, with the adapted threshold and the fire mask in v_thr/test.
+// Lanes cleared in ready (refractory pixels) never fire.
+template<class S>
+inline cv::v_float32 vecStep(const cv::v_float32& v_src, typename S::T* ref,
+                             typename S::T* thr, const VecParams& k,
+                             const cv::v_float32& ready,
+                             cv::v_float32& v_thr, cv::v_float32& test)
+{
+    const cv::v_float32 v_ref {S::load(ref)};
+    v_thr = S::load(thr) * k.scale;
+    cv::v_float32 v_diff {v_src - v_ref};
+    test = ((v_diff < (k.zero - v_thr)) | (v_diff > v_thr)) & ready;
+    v_diff = v_diff & test;
+    S::store(ref, (k.relax * v_ref) + v_diff);
+    v_thr = v_thr * cv::v_select(test, k.up, k.down);
+    S::store(thr, v_thr);
+    return v_diff;
+}
+#endif
+
+// Scalar counterpart of vecStep
+template<class S>
+inline float scalarStep(const float src, typename S::T* ref, typename S::T* thr,
+                        const RowParams& p, const bool ready, float& t, bool& test)
+{
+    const float r {S::get(ref)};
+    t = S::get(thr) * p.scale;
+    float d {src - r};
+    test = ((d < -t) || (d > t)) && ready;
+    d = d * (static_cast<float>(test));
+    S::set(ref, (p.relax * r) + d);
+    t = t * (test ? p.up : p.down);
+    S::set(thr, t);
+    return d;
+}
+
+#if CV_SIMD
+// One vector of gray input, 8-bit sources are widened in registers
+inline cv::v_float32 loadSrc(const float* p)
+{
+    return cv::vx_load(p);
+}
+
+inline cv::v_float32 loadSrc(const uchar* p)
+{
+    return cv::v_cvt_f32(cv::v_reinterpret_as_s32(cv::vx_load_expand_q(p)));
+}
+#endif
+
+// Emulator over a contiguous run of pixels of float or 8-bit gray input
+// (Src). diff may be null, then it only lives in registers. ts (last fire stamps) may be null when not tracked,
+// otherwise pixels that fired p.window or fewer frames ago are masked out.
+// Signed events are added to the voxel grid rows vox0/vox1 (weights
+// p.w0/p.w1) when they are not null.
+template<class S, class Src>
+void spanKernel(const Src* src, typename S::T* ref, typename S::T* thr,
+                ushort* ts, float* diff, cv::Vec3f* ev, float* vox0,
+                float* vox1, const int cols, const RowParams& p)
+{
+    int col {0};
+#if CV_SIMD
+    const int lanes {cv::v_float32::nlanes};
+    float* out {reinterpret_cast<float*>(ev)};
+    const VecParams k(p);
+
+    for (; col <= cols - lanes; col += lanes)
+    {
+        // Refractory mask from the 16-bit stamp age, modulo 2^16
+        cv::v_uint32 v_ts;
+        cv::v_float32 ready {k.all};
+        if (ts != nullptr)
+        {
+            v_ts = cv::vx_load_expand(ts + col);
+            const cv::v_uint32 age {(k.stamp - v_ts) & k.mask16};
+            ready = cv::v_reinterpret_as_f32(~(age <= k.window));
+        }
+
+        cv::v_float32 v_thr, test;
+        const cv::v_float32 v_diff {vecStep<S>(loadSrc(src + col), ref + col,
+                                               thr + col, k, ready, v_thr, test)};
+        if (diff != nullptr)
+        {
+            cv::v_store(diff + col, v_diff);
+        }
+        if (ts != nullptr)
+        {
+            cv::v_pack_store(ts + col, cv::v_select(cv::v_reinterpret_as_u32(test),
+                                                    k.stamp, v_ts));
+        }
+
+        // Processing event frame, BGR interleaved
+        const cv::v_float32 blue {k.on & (v_diff > v_thr)};
+        const cv::v_float32 red {k.off & (v_diff < (k.zero - v_thr))};
+        cv::v_store_interleave(out + 3 * col, blue, k.zero, red);
+
+        if (vox0 != nullptr)
+        {
+            const cv::v_float32 pol {blue - red};
+            cv::v_store(vox0 + col, cv::vx_load(vox0 + col) + pol * k.w0);
+            if (vox1 != nullptr)
+            {
+                cv::v_store(vox1 + col, cv::vx_load(vox1 + col) + pol * k.w1);
+            }
+        }
+    }
+#endif
+
+    for (; col < cols; ++col) 
+    {
+        const bool ready {ts == nullptr ||
+                          static_cast<ushort>(p.stamp - ts[col]) > p.window};
+        float t;
+        bool test;
+        const float d {scalarStep<S>(static_cast<float>(src[col]), ref + col,
+                                     thr + col, p, ready,
+                                     t, test)};
+        if (diff != nullptr)
+        {
+            diff[col] = d;
+        }
+        if (ts != nullptr && test)
+        {
+            ts[col] = p.stamp;
+        }
+
+        // Processing event frame
+        cv::Vec3f color(0.0f, 0.0f, 0.0f);
+        if(d > t && p.on) // negative event
+        {
+            color[0] = 1.0f; // blue
+        } 
+        else if(d < -t && p.off) // positive event
+        {
+            color[2] = 1.0f; // red
+        } 
+        ev[col] = color;
+
+        if (vox0 != nullptr)
+        {
+            const float pol {color[0] - color[2]};
+            vox0[col] += pol * p.w0;
+            if (vox1 != nullptr)
+            {
+                vox1[col] += pol * p.w1;
+            }
+        }
+    }
+}
+
+// Color emulator over one row of 8-bit BGR input. ref/thr rows hold the
+// B, G and R planes back to back. The event of every channel is written to
+// the same channel of ev: +1 for diff > thr, -1 for diff < -thr.
+template<class S>
+void colorKernel(const uchar* src, typename S::T* ref, typename S::T* thr,
+                 cv::Vec3f* ev, const int cols, const RowParams& p)
+{
+    typename S::T* refs[3] {ref, ref + cols, ref + 2 * cols};
+    typename S::T* thrs[3] {thr, thr + cols, thr + 2 * cols};
+    int col {0};
+#if CV_SIMD
+    const int lanes {cv::v_uint8::nlanes};
+    const int flanes {cv::v_float32::nlanes};
+    float* out {reinterpret_cast<float*>(ev)};
+    const VecParams k(p);
+
+    for (; col <= cols - lanes; col += lanes)
+    {
+        // Deinterleave in registers, then widen every channel to 4 float vectors
+        cv::v_uint8 bgr[3];
+        cv::v_load_deinterleave(src + 3 * col, bgr[0], bgr[1], bgr[2]);
+
+        cv::v_float32 pol[3][4];
+        for (int ch{0}; ch < 3; ++ch)
+        {
+            cv::v_uint16 lo, hi;
+            cv::v_expand(bgr[ch], lo, hi);
+            cv::v_uint32 q[4];
+            cv::v_expand(lo, q[0], q[1]);
+            cv::v_expand(hi, q[2], q[3]);
+            for (int i{0}; i < 4; ++i)
+            {
+                const int x {col + i * flanes};
+                cv::v_float32 v_thr, test;
+                const cv::v_float32 v_diff {vecStep<S>(
+                    cv::v_cvt_f32(cv::v_reinterpret_as_s32(q[i])),
+                    refs[ch] + x, thrs[ch] + x, k, k.all, v_thr, test)};
+                pol[ch][i] = (k.on & (v_diff > v_thr)) -
+                             (k.off & (v_diff < (k.zero - v_thr)));
+            }
+        }
+
+        for (int i{0}; i < 4; ++i)
+        {
+            cv::v_store_interleave(out + 3 * (col + i * flanes),
+                                   pol[0][i], pol[1][i], pol[2][i]);
+        }
+    }
+#endif
+
+    for (; col < cols; ++col)
+    {
+        cv::Vec3f pol(0.0f, 0.0f, 0.0f);
+        for (int ch{0}; ch < 3; ++ch)
+        {
+            float t;
+            bool test;
+            const float d {scalarStep<S>(static_cast<float>(src[3 * col + ch]),
+                                         refs[ch] + col, thrs[ch] + col, p, true,
+                                         t, test)};
+            if(d > t && p.on)
+            {
+                pol[ch] = 1.0f;
+            }
+            else if(d < -t && p.off)
+            {
+                pol[ch] = -1.0f;
+            }
+        }
+        ev[col] = pol;
+    }
+}
+
+// Interleaved layout: every DVS_TILE pixels of a row are stored as
+// { ref[DVS_TILE], thr[DVS_TILE], stamp[DVS_TILE] (optional) }
+template<class S, class Src>
+void tileKernel(const Src* src, uchar* tiles, const bool stamps,
+                cv::Vec3f* ev, float* vox0, float* vox1, const int cols,
+                const RowParams& p)
+{
+    const size_t tileBytes {DVS_TILE * (2 * sizeof(typename S::T) +
+                                        (stamps ? sizeof(ushort) : 0))};
+    for (int col{0}; col < cols; col += DVS_TILE, tiles += tileBytes)
+    {
+        typename S::T* t_ref {reinterpret_cast<typename S::T*>(tiles)};
+        typename S::T* t_thr {t_ref + DVS_TILE};
+        ushort* t_ts {stamps ? reinterpret_cast<ushort*>(t_thr + DVS_TILE) : nullptr};
+        spanKernel<S>(src + col, t_ref, t_thr, t_ts, nullptr, ev + col,
+                      vox0 == nullptr ? nullptr : vox0 + col,
+                      vox1 == nullptr ? nullptr : vox1 + col,
+                      std::min(DVS_TILE, cols - col), p);
+    }
+}
+
+// State images of one pass, tiles is null for the planar layout
+struct RowState
+{
+    cv::Mat* ref;
+    cv::Mat* thr;
+    cv::Mat* diff;
+    cv::Mat* stamp;
+    cv::Mat* tiles;
+    bool tileStamps;
+    bool color;
+    cv::Mat* voxel;
+    int bin0; // voxel bins of the frame, bin1 is -1 for a single bin
+    int bin1;
+};
+
+template<class S, class Src>
+void grayRow(const Src* src, const int row, cv::Vec3f* ev, float* vox0,
+             float* vox1, const int cols, const RowState& st, const RowParams& p)
+{
+    if (st.tiles != nullptr)
+    {
+        tileKernel<S>(src, st.tiles->ptr(row), st.tileStamps, ev, vox0, vox1,
+                      cols, p);
+        return;
+    }
+    spanKernel<S>(src, st.ref->ptr<typename S::T>(row), st.thr->ptr<typename S::T>(row),
+                  st.stamp != nullptr ? st.stamp->ptr<ushort>(row) : nullptr,
+                  st.diff != nullptr ? st.diff->ptr<float>(row) : nullptr,
+                  ev, vox0, vox1, cols, p);
+}
+
+template<class S>
+void runRow(const int row, const cv::Mat& frame, cv::Vec3f* ev,
+            const RowState& st, const RowParams& p)
+{
+    const int cols {frame.cols};
+    if (st.color)
+    {
+        colorKernel<S>(frame.ptr<uchar>(row), st.ref->ptr<typename S::T>(row),
+                       st.thr->ptr<typename S::T>(row), ev, cols, p);
+        return;
+    }
+
+    float* vox0 {nullptr};
+    float* vox1 {nullptr};
+    if (st.voxel != nullptr)
+    {
+        vox0 = st.voxel->ptr<float>(st.bin0 * frame.rows + row);
+        vox1 = st.bin1 < 0 ? nullptr : st.voxel->ptr<float>(st.bin1 * frame.rows + row);
+    }
+
+    // 8-bit gray input (raw frames) skips the float conversion pass
+    if (frame.depth() == CV_8U)
+    {
+        grayRow<S>(frame.ptr<uchar>(row), row, ev, vox0, vox1, cols, st, p);
+    }
+    else
+    {
+        grayRow<S>(frame.ptr<float>(row), row, ev, vox0, vox1, cols, st, p);
+    }
+}
+
+template<class S>
+void packTilesAs(const cv::Mat& ref32, const cv::Mat& thr32, cv::Mat& tiles,
+                 const bool stamps)
+{
+    const int numTiles {(ref32.cols + DVS_TILE - 1) / DVS_TILE};
+    const size_t tileBytes {DVS_TILE * (2 * sizeof(typename S::T) +
+                                        (stamps ? sizeof(ushort) : 0))};
+    tiles = cv::Mat::zeros(ref32.rows, static_cast<int>(numTiles * tileBytes), CV_8U);
+    for (int row{0}; row < ref32.rows; ++row)
+    {
+        const float* it_ref {ref32.ptr<float>(row)};
+        const float* it_thr {thr32.ptr<float>(row)};
+        uchar* it_tile {tiles.ptr(row)};
+        for (int col{0}; col < ref32.cols; col += DVS_TILE, it_tile += tileBytes)
+        {
+            typename S::T* t_ref {reinterpret_cast<typename S::T*>(it_tile)};
+            typename S::T* t_thr {t_ref + DVS_TILE};
+            for (int i{0}; i < std::min(DVS_TILE, ref32.cols - col); ++i)
+            {
+                S::set(t_ref + i, it_ref[col + i]);
+                S::set(t_thr + i, it_thr[col + i]);
+            }
+        }
+    }
+}
+
+template<class S>
+void unpackTilesAs(const cv::Mat& tiles, cv::Mat& out, const int cols,
+                   const bool stamps, const int field)
+{
+    const size_t tileBytes {DVS_TILE * (2 * sizeof(typename S::T) +
+                                        (stamps ? sizeof(ushort) : 0))};
+    out.create(tiles.rows, cols, field == DVS_TILE_STAMP ? CV_16U : CV_32F);
+    for (int row{0}; row < tiles.rows; ++row)
+    {
+        const uchar* it_tile {tiles.ptr(row)};
+        for (int col{0}; col < cols; col += DVS_TILE, it_tile += tileBytes)
+        {
+            const typename S::T* t_ref {reinterpret_cast<const typename S::T*>(it_tile)};
+            const typename S::T* t_thr {t_ref + DVS_TILE};
+            const ushort* t_ts {reinterpret_cast<const ushort*>(t_thr + DVS_TILE)};
+            for (int i{0}; i < std::min(DVS_TILE, cols - col); ++i)
+            {
+                switch (field)
+                {
+                case DVS_TILE_REF:
+                    out.ptr<float>(row)[col + i] = S::get(t_ref + i);
+                    break;
+                case DVS_TILE_THR:
+                    out.ptr<float>(row)[col + i] = S::get(t_thr + i);
+                    break;
+                default:
+                    out.ptr<ushort>(row)[col + i] = stamps ? t_ts[i] : 0;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+template<class S>
+void convertState(const cv::Mat& state, cv::Mat& packed, const int type)
+{
+    packed.create(state.rows, state.cols, type);
+    for (int row{0}; row < state.rows; ++row)
+    {
+        const float* it_state {state.ptr<float>(row)};
+        typename S::T* it_packed {packed.ptr<typename S::T>(row)};
+        for (int col{0}; col < state.cols; ++col)
+        {
+            S::set(it_packed + col, it_state[col]);
+        }
+    }
+}
+
+template<class S>
+void expandState(const cv::Mat& packed, cv::Mat& state)
+{
+    state.create(packed.rows, packed.cols, CV_32F);
+    for (int row{0}; row < packed.rows; ++row)
+    {
+        const typename S::T* it_packed {packed.ptr<typename S::T>(row)};
+        float* it_state {state.ptr<float>(row)};
+        for (int col{0}; col < packed.cols; ++col)
+        {
+            it_state[col] = S::get(it_packed + col);
+        }
+    }
+}
+
+} // namespace
+
 // Constructor
 DVSOperator::DVSOperator()
     : src(nullptr), diff(nullptr), ref(nullptr), thr(nullptr),
-      ev(nullptr), relax(1.0f), up(1.0f), down(1.0f)
+      ev(nullptr), relax(1.0f), up(1.0f), down(1.0f),
+      thrBase(0.0f), thrScale(1.0f), mode(DVS_OUTPUT_BOTH), refractory(0),
+      srcBatch(nullptr), evBatch(nullptr), batchSize(0), batchRows(1),
+      storage(DVS_STORAGE_FP32), stamps(nullptr), tiles(nullptr),
+      tileStamps(false), color(false), frameStamp(DVS_STAMP_START),
+      voxel(nullptr), voxelBins(0), voxelWindow(0), voxelFrame(0), stampClock(0)
 {
 
 }
@@ -11,8 +546,13 @@ DVSOperator::DVSOperator()
 DVSOperator::DVSOperator(cv::Mat* _src, cv::Mat* _diff, 
                          cv::Mat* _ref, cv::Mat* _thr, cv::Mat* _ev,
                          float _relax, float _up, float _down)
-    : src(_src), diff(_diff), ref(_ref), thr(_thr),
-      relax(_relax), up(_up), down(_down)
+    : src(_src), diff(_diff), ref(_ref), thr(_thr), ev(_ev),
+      relax(_relax), up(_up), down(_down),
+      thrBase(0.0f), thrScale(1.0f), mode(DVS_OUTPUT_BOTH), refractory(0),
+      srcBatch(nullptr), evBatch(nullptr), batchSize(0), batchRows(1),
+      storage(DVS_STORAGE_FP32), stamps(nullptr), tiles(nullptr),
+      tileStamps(false), color(false), frameStamp(DVS_STAMP_START),
+      voxel(nullptr), voxelBins(0), voxelWindow(0), voxelFrame(0), stampClock(0)
 {
 
 }
@@ -20,7 +560,8 @@ DVSOperator::DVSOperator(cv::Mat* _src, cv::Mat* _diff,
 // Init method
 void DVSOperator::init(cv::Mat* _src, cv::Mat* _diff, 
                        cv::Mat* _ref, cv::Mat* _thr, cv::Mat* _ev,
-                       const float _relax, const float _up, const float _down)
+                       const float _relax, const float _up, const float _down,
+                       const int _storage)
 {
     std::cout << "In DVS_OP init function \n";
     src = _src;
@@ -31,62 +572,325 @@ void DVSOperator::init(cv::Mat* _src, cv::Mat* _diff,
     relax = _relax; 
     up = _up;
     down = _down;
+    thrBase = 0.0f;
+    thrScale = 1.0f;
+    mode = DVS_OUTPUT_BOTH;
+    refractory = 0;
+    batchSize = 0;
+    storage = _storage;
+    stamps = nullptr;
+    tiles = nullptr;
+    tileStamps = false;
+    color = false;
+    frameStamp = DVS_STAMP_START;
+    stampClock = 0;
+    voxel = nullptr;
+    voxelBins = 0;
+    voxelWindow = 0;
+    voxelFrame = 0;
     std::cout << "relax "<< relax << " up " << up << " down " << down << '\n';
 }
 
-void DVSOperator::operator()(const cv::Range& range) const
+// Apply runtime parameters, only call between frames.
+// A new base threshold rescales the adapted per-pixel threshold on the
+// next pass instead of resetting it, so no event burst is produced.
+void DVSOperator::setParams(const DVSParams& params)
 {
-    for (int row{range.start}; row < range.end; ++row) 
+    relax = params.relax;
+    up = params.up;
+    down = params.down;
+    mode = params.mode;
+    refractory = static_cast<ushort>(std::min(std::max(params.refractory, 0),
+                                              DVS_REFRACTORY_MAX - 1));
+    if(thrBase > 0.0f && params.thr > 0.0f)
     {
-        float const* it_src{src->ptr<float>(row)};
-        float* it_diff{diff->ptr<float>(row)};
-        float* it_ref{ref->ptr<float>(row)};
-        float* it_thr{thr->ptr<float>(row)};
+        thrScale *= params.thr / thrBase;
+    }
+    thrBase = params.thr;
+}
+
+// Process the next operator() calls over count frames at once, events of
+// frame k are written to (*evs)[k]. Pass count = 0 to go back to single frames.
+void DVSOperator::setBatch(const std::vector<cv::Mat>* srcs,
+                           std::vector<cv::Mat>* evs, const size_t count)
+{
+    srcBatch = srcs;
+    evBatch = evs;
+    batchSize = (srcs != nullptr && evs != nullptr) ? count : 0;
+
+    // ref, thr and diff rows are reused by every frame of the batch
+    const size_t rowBytes {static_cast<size_t>(src->cols) * sizeof(float) * 3};
+    batchRows = static_cast<int>(std::max<size_t>(1, BATCH_BLOCK_BYTES / rowBytes));
+}
+
+// Keep the last fire stamp of every pixel in stamp (CV_16U), null to disable.
+// Only used by the planar layout, tiles carry their own stamps.
+void DVSOperator::setStamps(cv::Mat* _stamp)
+{
+    stamps = _stamp;
+}
+
+// Switch to the interleaved layout, ref/thr are then read from _tiles.
+// Pass null to go back to the planar ref/thr images.
+void DVSOperator::setTiles(cv::Mat* _tiles, const bool _stamps)
+{
+    tiles = _tiles;
+    tileStamps = _tiles != nullptr && _stamps;
+}
+
+// Color mode: src is 8-bit BGR and ref/thr rows hold 3 planes (B, G, R)
+// of the frame width each. Only the planar layout is supported.
+void DVSOperator::setColor(const bool _color)
+{
+    color = _color;
+}
 
-        for (int col(0); col < src->cols; ++col) 
+// Accumulate signed events (+1 for blue, -1 for red) into _voxel, a
+// CV_32F image of bins frame-height images stacked vertically. Frame i of
+// every window of window frames sits at t = i * (bins - 1) / (window - 1)
+// and is split between bins floor(t) and floor(t) + 1 (bilinear in time).
+// Passes must not cross a window end. Not used in color mode.
+void DVSOperator::setVoxel(cv::Mat* _voxel, const size_t bins, const size_t window)
+{
+    voxel = (bins > 0 && window > 0) ? _voxel : nullptr;
+    voxelBins = bins;
+    voxelWindow = window;
+    voxelFrame = 0;
+}
+
+// Clear the one-shot threshold rescale after a pass, frames is the number
+// of frames the pass covered
+void DVSOperator::endFrame(const size_t frames)
+{
+    thrScale = 1.0f;
+    frameStamp = static_cast<ushort>(frameStamp + frames);
+    if(voxelWindow > 0)
+    {
+        voxelFrame = (voxelFrame + frames) % voxelWindow;
+    }
+
+    stampClock += frames;
+    if(stampClock >= DVS_STAMP_CLAMP_FRAMES)
+    {
+        clampStamps();
+        stampClock = 0;
+    }
+}
+
+// Pull stamps older than DVS_REFRACTORY_MAX up to that age, see
+// DVS_STAMP_CLAMP_FRAMES. One pass over the stamps every 2^14 frames.
+void DVSOperator::clampStamps()
+{
+    const ushort oldest {static_cast<ushort>(frameStamp - DVS_REFRACTORY_MAX)};
+    const auto clampSpan = [&](ushort* ts, const int n)
+    {
+        for(int col{0}; col < n; ++col)
         {
-            (*it_diff) = (*it_src) - (*it_ref);
-            bool test {(((*it_diff) < -(*it_thr)) || ((*it_diff) > (*it_thr)))};
-            (*it_diff) = (*it_diff) * (static_cast<float>(test));
-            (*it_ref) = (relax * (*it_ref)) + (*it_diff);
-            
-            if(test)
+            if(static_cast<ushort>(frameStamp - ts[col]) >= DVS_REFRACTORY_MAX)
             {
-                (*it_thr) = (*it_thr) * up;
+                ts[col] = oldest;
             }
-            else
+        }
+    };
+
+    if(stamps != nullptr && !stamps->empty())
+    {
+        for(int row{0}; row < stamps->rows; ++row)
+        {
+            clampSpan(stamps->ptr<ushort>(row), stamps->cols);
+        }
+    }
+    if(tiles != nullptr && tileStamps)
+    {
+        // Stamps follow ref[DVS_TILE] and thr[DVS_TILE] in every tile
+        const size_t elem {storage == DVS_STORAGE_FP32 ? sizeof(float) : sizeof(ushort)};
+        const size_t stampOffset {2 * DVS_TILE * elem};
+        const size_t tileBytes {stampOffset + DVS_TILE * sizeof(ushort)};
+        for(int row{0}; row < tiles->rows; ++row)
+        {
+            uchar* it_tile {tiles->ptr(row)};
+            const size_t numTiles {static_cast<size_t>(tiles->cols) / tileBytes};
+            for(size_t t{0}; t < numTiles; ++t, it_tile += tileBytes)
             {
-                (*it_thr) = (*it_thr) * down;
+                clampSpan(reinterpret_cast<ushort*>(it_tile + stampOffset), DVS_TILE);
             }
+        }
+    }
+}
 
-            // Processing event frame
-            cv::Vec3f color(0.0f, 0.0f, 0.0f);
-            float val {diff->at<float>(row, col)};
-            if(val > (*it_thr)) // negative event
-            {
-                color[2] = 0.0; // red
-                color[1] = 0.0; // green
-                color[0] = 1.0; // blue
-            } 
-            else if(val < -(*it_thr)) // positive event
-            {
-                color[2] = 1.0; // red
-                color[1] = 0.0; // green
-                color[0] = 0.0; // blue
-            } 
-            else // no event
+void DVSOperator::operator()(const cv::Range& range) const
+{
+    if(batchSize == 0)
+    {
+        for (int row{range.start}; row < range.end; ++row) 
+        {
+            processRow(row, *src, ev->ptr<cv::Vec3f>(row), thrScale, 0);
+        }
+        return;
+    }
+
+    // Temporal blocking: advance one row block through every frame of the
+    // batch before moving on, so its ref/thr/diff rows stay in L1/L2
+    for (int start{range.start}; start < range.end; start += batchRows)
+    {
+        const int end {std::min(range.end, start + batchRows)};
+        for (size_t k{0}; k < batchSize; ++k)
+        {
+            // The pending threshold rescale belongs to the first frame only
+            const float scale {k == 0 ? thrScale : 1.0f};
+            for (int row{start}; row < end; ++row)
             {
-                color[2] = 0.0; // red
-                color[1] = 0.0; // green
-                color[0] = 0.0; // blue
+                processRow(row, (*srcBatch)[k], (*evBatch)[k].ptr<cv::Vec3f>(row),
+                           scale, k);
             }
-            ev->at<cv::Vec3f>(row, col) = color;
-            
-            //advance pointers
-            ++it_src; 
-            ++it_diff; 
-            ++it_ref;
-            ++it_thr; 
         }
     }
-}
\ No newline at end of file
+}
+
+// Run rows of range without keeping the event frame: events of every row
+// go to scratch (one row, src->cols elements) and are only counted, on for
+// blue and off for red. The diff image is not written either when the
+// operator was initialized without one.
+void DVSOperator::countRows(const cv::Range& range, cv::Vec3f* scratch,
+                            uint64_t& on, uint64_t& off) const
+{
+    on = 0;
+    off = 0;
+    for (int row{range.start}; row < range.end; ++row)
+    {
+        processRow(row, *src, scratch, thrScale, 0);
+        for (int col{0}; col < src->cols; ++col)
+        {
+            on += static_cast<uint64_t>(scratch[col][0] > 0.0f);
+            off += static_cast<uint64_t>(scratch[col][2] > 0.0f);
+        }
+    }
+}
+
+// k is the frame offset from the current one within a batch, events of
+// the row are written to it_ev
+void DVSOperator::processRow(const int row, const cv::Mat& frame,
+                             cv::Vec3f* it_ev, const float scale,
+                             const size_t k) const
+{
+    // Temporal position of the frame in the voxel grid window
+    int bin0 {0};
+    int bin1 {-1};
+    float w1 {0.0f};
+    if(voxel != nullptr && voxelWindow > 1)
+    {
+        const float t {static_cast<float>((voxelFrame + k) * (voxelBins - 1)) /
+                       static_cast<float>(voxelWindow - 1)};
+        bin0 = std::min(static_cast<int>(t), static_cast<int>(voxelBins) - 1);
+        w1 = t - static_cast<float>(bin0);
+        bin1 = w1 > 0.0f ? bin0 + 1 : -1;
+    }
+
+    const RowParams p {relax, up, down, scale,
+                       mode != DVS_OUTPUT_OFF, mode != DVS_OUTPUT_ON,
+                       static_cast<ushort>(frameStamp + k), refractory,
+                       1.0f - w1, w1};
+    // The difference is only materialized for planar float state
+    const bool planar32 {storage == DVS_STORAGE_FP32 && tiles == nullptr && !color};
+    const RowState st {ref, thr, planar32 ? diff : nullptr,
+                       stamps, tiles, tileStamps, color, voxel, bin0, bin1};
+
+    switch(storage)
+    {
+    case DVS_STORAGE_FP16:
+        runRow<StateF16>(row, frame, it_ev, st, p);
+        break;
+    case DVS_STORAGE_BF16:
+        runRow<StateBF16>(row, frame, it_ev, st, p);
+        break;
+    default:
+        runRow<StateF32>(row, frame, it_ev, st, p);
+        break;
+    }
+}
+
+// Pack CV_32F ref/thr images into the interleaved tile layout
+void DVSOperator::packTiles(const cv::Mat& ref32, const cv::Mat& thr32, cv::Mat& tiles,
+                            const int storage, const bool stamps)
+{
+    switch(storage)
+    {
+    case DVS_STORAGE_FP16:
+        packTilesAs<StateF16>(ref32, thr32, tiles, stamps);
+        break;
+    case DVS_STORAGE_BF16:
+        packTilesAs<StateBF16>(ref32, thr32, tiles, stamps);
+        break;
+    default:
+        packTilesAs<StateF32>(ref32, thr32, tiles, stamps);
+        break;
+    }
+}
+
+// Materialize one field (DVSTileField) of the tile layout as an image
+void DVSOperator::unpackTiles(const cv::Mat& tiles, cv::Mat& out, const int cols,
+                              const int storage, const bool stamps, const int field)
+{
+    switch(storage)
+    {
+    case DVS_STORAGE_FP16:
+        unpackTilesAs<StateF16>(tiles, out, cols, stamps, field);
+        break;
+    case DVS_STORAGE_BF16:
+        unpackTilesAs<StateBF16>(tiles, out, cols, stamps, field);
+        break;
+    default:
+        unpackTilesAs<StateF32>(tiles, out, cols, stamps, field);
+        break;
+    }
+}
+
+// Smallest |1 - rate| a multiplicative ref/thr update (relax, up, down)
+// is sure to survive in the storage format: half the ULP of 1. Closer
+// rates round back to the stored value and freeze relaxation/adaptation.
+float DVSOperator::storagePrecision(const int storage)
+{
+    switch(storage)
+    {
+    case DVS_STORAGE_FP16:
+        return 1.0f / 2048.0f; // 10 bit mantissa
+    case DVS_STORAGE_BF16:
+        return 1.0f / 256.0f;  // 7 bit mantissa
+    default:
+        return 0.0f;
+    }
+}
+
+// Convert a CV_32F state image into the given storage format
+void DVSOperator::packState(const cv::Mat& state, cv::Mat& packed, const int storage)
+{
+    switch(storage)
+    {
+    case DVS_STORAGE_FP16:
+        convertState<StateF16>(state, packed, CV_16F);
+        break;
+    case DVS_STORAGE_BF16:
+        convertState<StateBF16>(state, packed, CV_16U);
+        break;
+    default:
+        packed = state;
+        break;
+    }
+}
+
+// Expand a packed state image back to CV_32F, for debugging and display
+void DVSOperator::unpackState(const cv::Mat& packed, cv::Mat& state, const int storage)
+{
+    switch(storage)
+    {
+    case DVS_STORAGE_FP16:
+        expandState<StateF16>(packed, state);
+        break;
+    case DVS_STORAGE_BF16:
+        expandState<StateBF16>(packed, state);
+        break;
+    default:
+        state = packed;
+        break;
+    }
+}
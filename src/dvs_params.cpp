@@ -0,0 +1,93 @@
+#include "dvs_params.hpp"
+
+// Constructor
+DVSParamBlock::DVSParamBlock()
+    : _seq(0), _thr(0.0f), _relax(1.0f), _up(1.0f), _down(1.0f),
+      _mode(DVS_OUTPUT_BOTH), _refractory(0)
+{
+
+}
+
+// Publish a new parameter set, sequence is odd while the write is in flight
+void DVSParamBlock::publish(const DVSParams& params)
+{
+    const uint32_t seq {_lock()};
+    _store(params);
+    _seq.store(seq + 2, std::memory_order_release);
+}
+
+// Writer side: make the sequence odd, returns the even value it had.
+// Writers exclude each other, readers see the odd value and retry.
+uint32_t DVSParamBlock::_lock()
+{
+    uint32_t seq {_seq.load(std::memory_order_relaxed)};
+    do
+    {
+        seq &= ~1u;
+    } while(!_seq.compare_exchange_weak(seq, seq + 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+    return seq;
+}
+
+void DVSParamBlock::_load(DVSParams& params) const
+{
+    params.thr = _thr.load(std::memory_order_relaxed);
+    params.relax = _relax.load(std::memory_order_relaxed);
+    params.up = _up.load(std::memory_order_relaxed);
+    params.down = _down.load(std::memory_order_relaxed);
+    params.mode = _mode.load(std::memory_order_relaxed);
+    params.refractory = _refractory.load(std::memory_order_relaxed);
+}
+
+void DVSParamBlock::_store(const DVSParams& params)
+{
+    _thr.store(params.thr, std::memory_order_relaxed);
+    _relax.store(params.relax, std::memory_order_relaxed);
+    _up.store(params.up, std::memory_order_relaxed);
+    _down.store(params.down, std::memory_order_relaxed);
+    _mode.store(params.mode, std::memory_order_relaxed);
+    _refractory.store(params.refractory, std::memory_order_relaxed);
+}
+
+// Copy the current parameters if they are newer than version and consistent.
+// Returns false (params untouched) when nothing new or a publish is in flight.
+bool DVSParamBlock::tryRead(DVSParams& params, uint32_t& version) const
+{
+    const uint32_t seq {_seq.load(std::memory_order_acquire)};
+    if((seq & 1u) || seq == version)
+    {
+        return false;
+    }
+
+    DVSParams p;
+    _load(p);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(_seq.load(std::memory_order_relaxed) != seq)
+    {
+        return false;
+    }
+
+    params = p;
+    version = seq;
+    return true;
+}
+
+// Consistent copy of the last published parameters, waits out a publish
+// in flight. For control threads, the processing thread uses tryRead().
+void DVSParamBlock::read(DVSParams& params) const
+{
+    // Stable sequences are even, so an odd version never reads as "not new"
+    uint32_t version {1u};
+    while(!tryRead(params, version))
+    {
+        // A publish is in flight, it completes without waiting on us
+    }
+}
+
+uint32_t DVSParamBlock::version() const
+{
+    return _seq.load(std::memory_order_acquire);
+}
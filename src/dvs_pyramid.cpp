@@ -0,0 +1,177 @@
+#include "dvs_pyramid.hpp"
+
+#include <algorithm>
+#include "opencv2/core/hal/intrin.hpp"
+
+// 2x2 box filter of rows [2 * start, 2 * end) of src into rows [start, end) of dst
+static void boxDown(const cv::Mat& src, cv::Mat& dst, const int start, const int end)
+{
+    for (int row{start}; row < end; ++row)
+    {
+        const float* it_src0 {src.ptr<float>(2 * row)};
+        const float* it_src1 {src.ptr<float>(2 * row + 1)};
+        float* it_dst {dst.ptr<float>(row)};
+
+        int col {0};
+#if CV_SIMD
+        const int lanes {cv::v_float32::nlanes};
+        const cv::v_float32 v_quarter {cv::vx_setall_f32(0.25f)};
+        for (; col <= dst.cols - lanes; col += lanes)
+        {
+            cv::v_float32 e0, o0, e1, o1;
+            cv::v_load_deinterleave(it_src0 + 2 * col, e0, o0);
+            cv::v_load_deinterleave(it_src1 + 2 * col, e1, o1);
+            cv::v_store(it_dst + col, ((e0 + o0) + (e1 + o1)) * v_quarter);
+        }
+#endif
+        for (; col < dst.cols; ++col)
+        {
+            it_dst[col] = ((it_src0[2 * col] + it_src0[2 * col + 1]) +
+                           (it_src1[2 * col] + it_src1[2 * col + 1])) * 0.25f;
+        }
+    }
+}
+
+// Constructor
+DVSPyramid::DVSPyramid()
+    : _base(nullptr), _baseIn(nullptr), _levels(1),
+      _storage(DVS_STORAGE_FP32), _rows(0)
+{
+
+}
+
+// Init method, base runs level 0 on in (CV_32F), levels counts level 0
+bool DVSPyramid::init(DVSOperator* base, cv::Mat* in, const size_t levels,
+                      const int storage, const float thr, const float relax,
+                      const float up, const float down)
+{
+    // Halve instead of shifting by levels - 1, which may exceed the int width
+    int rows {in->rows};
+    int cols {in->cols};
+    for(size_t l{1}; l < levels && rows > 0 && cols > 0; ++l)
+    {
+        rows /= 2;
+        cols /= 2;
+    }
+    if(levels < 1 || levels > static_cast<size_t>(DVS_PYRAMID_MAX_LEVELS) ||
+       rows == 0 || cols == 0)
+    {
+        std::cerr << "Pyramid. Too many levels for the frame size!\n";
+        return false;
+    }
+
+    _base = base;
+    _baseIn = in;
+    _levels = levels;
+    _storage = storage;
+    _rows = rows;
+
+    const size_t n {levels - 1};
+    _in.resize(n);
+    _ref.resize(n);
+    _diff.resize(n);
+    _thr.resize(n);
+    _events.resize(n);
+    _ops.resize(n);
+    _refView.resize(n);
+    _thrView.resize(n);
+
+    // Every vector is sized before taking addresses, operators keep pointers
+    for(size_t l{0}; l < n; ++l)
+    {
+        const int h {in->rows >> (l + 1)};
+        const int w {in->cols >> (l + 1)};
+        _in[l] = cv::Mat::zeros(h, w, CV_32F);
+        _diff[l] = cv::Mat::zeros(h, w, CV_32F);
+        _events[l] = cv::Mat::zeros(h, w, CV_32FC3);
+        DVSOperator::packState(cv::Mat::zeros(h, w, CV_32F), _ref[l], storage);
+        DVSOperator::packState(thr * cv::Mat::ones(h, w, CV_32F), _thr[l], storage);
+        _ops[l].init(&_in[l], &_diff[l], &_ref[l], &_thr[l], &_events[l],
+                     relax, up, down, storage);
+    }
+
+    return true;
+}
+
+// Runtime parameters for the lower levels, level 0 is set by the owner
+void DVSPyramid::setParams(const DVSParams& params)
+{
+    for(DVSOperator& op : _ops)
+    {
+        op.setParams(params);
+    }
+}
+
+void DVSPyramid::endFrame(const size_t frames)
+{
+    for(DVSOperator& op : _ops)
+    {
+        op.endFrame(frames);
+    }
+}
+
+// range is in rows of the coarsest level, each covers 2^l rows of level
+// (levels - 1 - l). The last block also takes the leftover rows of every level.
+void DVSPyramid::operator()(const cv::Range& range) const
+{
+    const bool last {range.end == _rows};
+    for(size_t l{0}; l < _levels; ++l)
+    {
+        const cv::Mat& in {l == 0 ? *_baseIn : _in[l - 1]};
+        const int shift {static_cast<int>(_levels - 1 - l)};
+        const int start {range.start << shift};
+        const int end {last ? in.rows : (range.end << shift)};
+
+        if(l > 0)
+        {
+            const cv::Mat& finer {l == 1 ? *_baseIn : _in[l - 2]};
+            boxDown(finer, _in[l - 1], start, end);
+            _ops[l - 1](cv::Range(start, end));
+        }
+        else
+        {
+            (*_base)(cv::Range(start, end));
+        }
+    }
+}
+
+// Get parameter methods
+size_t DVSPyramid::getLevels() const
+{
+    return _levels;
+}
+
+int DVSPyramid::getRows() const
+{
+    return _rows;
+}
+
+cv::Mat& DVSPyramid::getInput(const size_t level)
+{
+    return _in[level - 1];
+}
+
+cv::Mat& DVSPyramid::getEvents(const size_t level)
+{
+    return _events[level - 1];
+}
+
+cv::Mat& DVSPyramid::getReference(const size_t level)
+{
+    if(_storage != DVS_STORAGE_FP32)
+    {
+        DVSOperator::unpackState(_ref[level - 1], _refView[level - 1], _storage);
+        return _refView[level - 1];
+    }
+    return _ref[level - 1];
+}
+
+cv::Mat& DVSPyramid::getThreshold(const size_t level)
+{
+    if(_storage != DVS_STORAGE_FP32)
+    {
+        DVSOperator::unpackState(_thr[level - 1], _thrView[level - 1], _storage);
+        return _thrView[level - 1];
+    }
+    return _thr[level - 1];
+}
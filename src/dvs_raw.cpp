@@ -0,0 +1,356 @@
+#include "dvs_raw.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Pipe buffer requested for stdin/FIFO input, lets the producer run ahead
+static const int RAW_PIPE_BYTES {4 * 1024 * 1024};
+
+// Constructor
+DVSRawSource::DVSRawSource()
+    : _fd(-1), _ownFd(false), _map(nullptr), _mapSize(0), _offset(0),
+      _format(DVS_RAW_GRAY8), _colorY4M(false), _w(0), _h(0), _fps(0),
+      _frameBytes(0), _skipBytes(0)
+{
+
+}
+
+// Destructor
+DVSRawSource::~DVSRawSource()
+{
+    close();
+}
+
+// Open method, w/h/fps are only used by the headerless formats
+bool DVSRawSource::open(const std::string& path, const int format,
+                        const size_t w, const size_t h, const size_t fps)
+{
+    close();
+    _format = format;
+    _w = w;
+    _h = h;
+    _fps = fps;
+
+    if(path == "-")
+    {
+        _fd = STDIN_FILENO;
+        _ownFd = false;
+    }
+    else
+    {
+        _fd = ::open(path.c_str(), O_RDONLY);
+        _ownFd = true;
+    }
+    if(_fd < 0)
+    {
+        std::cerr << "Raw. Cannot open " << path << ": " << std::strerror(errno) << "!\n";
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(_fd, &st) != 0)
+    {
+        std::cerr << "Raw. Cannot stat " << path << ": " << std::strerror(errno) << "!\n";
+        close();
+        return false;
+    }
+    if(S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        // Regular file, frames alias a private (copy-on-write) mapping
+        void* map {mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, _fd, 0)};
+        if(map != MAP_FAILED)
+        {
+            _map = static_cast<uint8_t*>(map);
+            _mapSize = st.st_size;
+            madvise(_map, _mapSize, MADV_SEQUENTIAL);
+        }
+    }
+#ifdef F_SETPIPE_SZ
+    else if(S_ISFIFO(st.st_mode))
+    {
+        // Best effort, the kernel may cap it
+        fcntl(_fd, F_SETPIPE_SZ, RAW_PIPE_BYTES);
+    }
+#endif
+
+    if(_format == DVS_RAW_Y4M)
+    {
+        std::string header;
+        if(!_readLine(header) || !_parseY4MHeader(header))
+        {
+            std::cerr << "Raw. Invalid YUV4MPEG2 header!\n";
+            close();
+            return false;
+        }
+    }
+    else
+    {
+        const size_t channels {_format == DVS_RAW_BGR24 ? 3u : 1u};
+        _frameBytes = _w * _h * channels;
+        _skipBytes = 0;
+    }
+
+    if(_w == 0 || _h == 0)
+    {
+        std::cerr << "Raw. Frame size must be set for headerless input!\n";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void DVSRawSource::close()
+{
+    if(_map != nullptr)
+    {
+        munmap(_map, _mapSize);
+        _map = nullptr;
+        _mapSize = 0;
+    }
+    if(_fd >= 0 && _ownFd)
+    {
+        ::close(_fd);
+    }
+    _fd = -1;
+    _offset = 0;
+}
+
+// Y4M only: deliver BGR frames (converted from 4:2:0) instead of the Y
+// plane, call before open()
+void DVSRawSource::setColor(const bool color)
+{
+    _colorY4M = color;
+}
+
+// Read the next frame. For pipes, frame must be preallocated (h x w, getType())
+// and is filled in place; for mapped files its header is pointed at the frame.
+bool DVSRawSource::read(cv::Mat& frame)
+{
+    if(_fd < 0)
+    {
+        return false;
+    }
+
+    if(_format == DVS_RAW_Y4M)
+    {
+        std::string tag;
+        if(!_readLine(tag) || tag.compare(0, 5, "FRAME") != 0)
+        {
+            return false;
+        }
+    }
+
+    // Y4M in color: read Y and chroma together and convert
+    if(_colorY4M)
+    {
+        const int rows {static_cast<int>(_h + _h / 2)};
+        if(_map != nullptr)
+        {
+            if(_offset + _frameBytes > _mapSize)
+            {
+                return false;
+            }
+            _yuv = cv::Mat(rows, _w, CV_8UC1, _map + _offset);
+            _offset += _frameBytes;
+        }
+        else
+        {
+            _yuv.create(rows, _w, CV_8UC1);
+            if(!_readFull(_yuv.data, _frameBytes))
+            {
+                return false;
+            }
+        }
+        cv::cvtColor(_yuv, frame, cv::COLOR_YUV2BGR_I420);
+        return true;
+    }
+
+    if(_map != nullptr)
+    {
+        if(_offset + _frameBytes + _skipBytes > _mapSize)
+        {
+            return false;
+        }
+        frame = cv::Mat(_h, _w, getType(), _map + _offset);
+        _offset += _frameBytes + _skipBytes;
+        return true;
+    }
+
+    CV_Assert(frame.isContinuous() && frame.total() * frame.elemSize() == _frameBytes);
+    if(!_readFull(frame.data, _frameBytes))
+    {
+        return false;
+    }
+    if(_skipBytes > 0)
+    {
+        _scratch.resize(_skipBytes);
+        return _readFull(_scratch.data(), _skipBytes);
+    }
+    return true;
+}
+
+// Blocking read of exactly n bytes, as few syscalls as the pipe allows
+bool DVSRawSource::_readFull(uint8_t* dst, const size_t n)
+{
+    size_t done {0};
+    while(done < n)
+    {
+        const ssize_t got {::read(_fd, dst + done, n - done)};
+        if(got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(got <= 0)
+        {
+            return false;
+        }
+        done += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// Header lines (Y4M stream and frame headers), without the newline
+bool DVSRawSource::_readLine(std::string& line)
+{
+    line.clear();
+    if(_map != nullptr)
+    {
+        const void* end {std::memchr(_map + _offset, '\n', _mapSize - _offset)};
+        if(end == nullptr)
+        {
+            return false;
+        }
+        const size_t len {static_cast<size_t>(static_cast<const uint8_t*>(end) - (_map + _offset))};
+        line.assign(reinterpret_cast<const char*>(_map + _offset), len);
+        _offset += len + 1;
+        return true;
+    }
+
+    // Headers are a few bytes, reading them bytewise keeps frames aligned
+    char c;
+    while(true)
+    {
+        const ssize_t got {::read(_fd, &c, 1)};
+        if(got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(got <= 0)
+        {
+            return false;
+        }
+        if(c == '\n')
+        {
+            return true;
+        }
+        line.push_back(c);
+    }
+}
+
+// YUV4MPEG2 W<w> H<h> F<num>:<den> C<colorspace> ...
+bool DVSRawSource::_parseY4MHeader(const std::string& header)
+{
+    std::istringstream ss(header);
+    std::string token;
+    ss >> token;
+    if(token != "YUV4MPEG2")
+    {
+        return false;
+    }
+
+    std::string colorspace {"420"};
+    while(ss >> token)
+    {
+        switch(token[0])
+        {
+        case 'W':
+            _w = std::strtoul(token.c_str() + 1, nullptr, 10);
+            break;
+        case 'H':
+            _h = std::strtoul(token.c_str() + 1, nullptr, 10);
+            break;
+        case 'F':
+        {
+            const size_t num {std::strtoul(token.c_str() + 1, nullptr, 10)};
+            const size_t sep {token.find(':')};
+            const size_t den {sep == std::string::npos ? 1 :
+                              std::strtoul(token.c_str() + sep + 1, nullptr, 10)};
+            _fps = den > 0 ? (num + den / 2) / den : 0;
+            break;
+        }
+        case 'C':
+            colorspace = token.substr(1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // 8-bit only: exact tags, so mono16 or 420p10 are rejected
+    const size_t luma {_w * _h};
+    if(colorspace == "mono")
+    {
+        _frameBytes = luma;
+        _skipBytes = 0;
+    }
+    else if(colorspace == "420" || colorspace == "420jpeg" ||
+            colorspace == "420paldv" || colorspace == "420mpeg2")
+    {
+        _frameBytes = luma;
+        _skipBytes = 2 * ((_w + 1) / 2) * ((_h + 1) / 2);
+    }
+    else
+    {
+        std::cerr << "Raw. Unsupported Y4M colorspace C" << colorspace << "!\n";
+        return false;
+    }
+
+    // Color output needs the whole 4:2:0 frame
+    if(_colorY4M)
+    {
+        if(_skipBytes == 0 || (_w % 2) != 0 || (_h % 2) != 0)
+        {
+            std::cerr << "Raw. Color Y4M input must be 4:2:0 with even size!\n";
+            return false;
+        }
+        _frameBytes += _skipBytes;
+        _skipBytes = 0;
+    }
+    return true;
+}
+
+// Get parameter methods
+size_t DVSRawSource::getWidth() const
+{
+    return _w;
+}
+
+size_t DVSRawSource::getHeight() const
+{
+    return _h;
+}
+
+size_t DVSRawSource::getFPS() const
+{
+    return _fps;
+}
+
+// Frame type returned by read(): 8-bit gray (Y plane for Y4M) or 8-bit BGR
+int DVSRawSource::getType() const
+{
+    return (_format == DVS_RAW_BGR24 || _colorY4M) ? CV_8UC3 : CV_8UC1;
+}
+
+bool DVSRawSource::isOpened() const
+{
+    return _fd >= 0;
+}
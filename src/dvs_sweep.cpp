@@ -0,0 +1,174 @@
+#include "dvs_sweep.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+// Per-task working set target, state of one row block should stay in L2
+static const size_t SWEEP_BLOCK_BYTES {256 * 1024};
+
+// Constructor
+DVSSweep::DVSSweep()
+    : _w(0), _h(0), _blockRows(1), _numBlocks(0), _frames(0)
+{
+
+}
+
+// Init method
+bool DVSSweep::init(const std::vector<DVSSweepConfig>& configs,
+                    const size_t w, const size_t h)
+{
+    if(configs.empty() || w == 0 || h == 0)
+    {
+        std::cerr << "Sweep. Empty parameter grid or frame size!\n";
+        return false;
+    }
+
+    _configs = configs;
+    _w = w;
+    _h = h;
+    _frames = 0;
+
+    // src, ref and thr (float) per pixel, events only live in a row scratch
+    const size_t rowBytes {_w * sizeof(float) * 3};
+    _blockRows = std::max<size_t>(1, SWEEP_BLOCK_BYTES / rowBytes);
+    _numBlocks = (_h + _blockRows - 1) / _blockRows;
+
+    const size_t m {_configs.size()};
+    _ref.resize(m);
+    _thr.resize(m);
+    _ops.resize(m);
+    _in = cv::Mat::zeros(_h, _w, CV_32F);
+
+    // Every vector is sized before taking addresses, operators keep pointers
+    for(size_t c{0}; c < m; ++c)
+    {
+        // No diff/event images, the sweep only keeps event counts
+        _ref[c] = cv::Mat::zeros(_h, _w, CV_32F);
+        _thr[c] = _configs[c].thr * cv::Mat::ones(_h, _w, CV_32F);
+        _ops[c].init(&_in, nullptr, &_ref[c], &_thr[c], nullptr,
+                     _configs[c].relax, _configs[c].up, _configs[c].down);
+    }
+
+    _blockOn.assign(m * _numBlocks, 0);
+    _blockOff.assign(m * _numBlocks, 0);
+    _totalOn.assign(m, 0);
+    _totalOff.assign(m, 0);
+    _peak.assign(m, 0);
+
+    return true;
+}
+
+// Run every configuration over one gray frame (CV_32F, or CV_8U raw input)
+void DVSSweep::update(const cv::Mat& in)
+{
+    CV_Assert((in.type() == CV_32F || in.type() == CV_8UC1) && in.rows == static_cast<int>(_h) &&
+              in.cols == static_cast<int>(_w));
+
+    // Shallow header copy, all operators read the caller's buffer
+    _in = in;
+
+    const size_t m {_configs.size()};
+    cv::parallel_for_(cv::Range(0, static_cast<int>(m * _numBlocks)), *this);
+
+    // Reduce block counters into per-config statistics
+    for(size_t c{0}; c < m; ++c)
+    {
+        uint64_t on {0};
+        uint64_t off {0};
+        for(size_t b{0}; b < _numBlocks; ++b)
+        {
+            on += _blockOn[b * m + c];
+            off += _blockOff[b * m + c];
+        }
+        _totalOn[c] += on;
+        _totalOff[c] += off;
+        _peak[c] = std::max(_peak[c], on + off);
+    }
+    ++_frames;
+}
+
+void DVSSweep::operator()(const cv::Range& range) const
+{
+    const size_t m {_configs.size()};
+    // Event row of the running task, reused by every task of this range
+    cv::AutoBuffer<cv::Vec3f> scratch(_w);
+    for(int task{range.start}; task < range.end; ++task)
+    {
+        // Configs are the fastest varying index, so consecutive tasks
+        // reuse the same input row block while it is still in cache
+        const size_t block {static_cast<size_t>(task) / m};
+        const size_t c {static_cast<size_t>(task) % m};
+        const int rowStart {static_cast<int>(block * _blockRows)};
+        const int rowEnd {static_cast<int>(std::min(_h, (block + 1) * _blockRows))};
+
+        uint64_t on;
+        uint64_t off;
+        _ops[c].countRows(cv::Range(rowStart, rowEnd), scratch.data(), on, off);
+        _blockOn[static_cast<size_t>(task)] = on;
+        _blockOff[static_cast<size_t>(task)] = off;
+    }
+}
+
+// Write per-config statistics as CSV
+bool DVSSweep::writeSummary(const std::string& filename) const
+{
+    std::ofstream out(filename);
+    if(!out.is_open())
+    {
+        std::cerr << "Sweep. Cannot open summary file " << filename << "!\n";
+        return false;
+    }
+
+    out << "thr,relax,adapt_up,adapt_down,frames,on_events,off_events,"
+        << "events_per_frame,peak_events_per_frame,event_rate\n";
+
+    const double pixels {static_cast<double>(_w * _h)};
+    for(size_t c{0}; c < _configs.size(); ++c)
+    {
+        const uint64_t total {_totalOn[c] + _totalOff[c]};
+        const double perFrame {_frames > 0 ?
+            static_cast<double>(total) / static_cast<double>(_frames) : 0.0};
+
+        out << _configs[c].thr << ',' << _configs[c].relax << ','
+            << _configs[c].up << ',' << _configs[c].down << ','
+            << _frames << ',' << _totalOn[c] << ',' << _totalOff[c] << ','
+            << perFrame << ',' << _peak[c] << ',' << perFrame / pixels << '\n';
+    }
+
+    return out.good();
+}
+
+// Cartesian product of the parameter lists
+std::vector<DVSSweepConfig> DVSSweep::grid(const std::vector<float>& thr,
+                                           const std::vector<float>& relax,
+                                           const std::vector<float>& up,
+                                           const std::vector<float>& down)
+{
+    std::vector<DVSSweepConfig> configs;
+    configs.reserve(thr.size() * relax.size() * up.size() * down.size());
+    for(float t : thr)
+    {
+        for(float r : relax)
+        {
+            for(float u : up)
+            {
+                for(float d : down)
+                {
+                    configs.push_back({t, r, u, d});
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+// Get parameter methods
+size_t DVSSweep::getNumConfigs() const
+{
+    return _configs.size();
+}
+
+size_t DVSSweep::getNumFrames() const
+{
+    return _frames;
+}
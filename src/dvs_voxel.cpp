@@ -0,0 +1,232 @@
+#include "dvs_voxel.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Dataset file header, see dvs_voxel.hpp
+struct VoxelHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t bins;
+    uint32_t height;
+    uint32_t width;
+    uint64_t count;
+};
+
+static const size_t VOXEL_HEADER_BYTES {sizeof(VoxelHeader)};
+
+// The dataset file is grown (and remapped) by at least this much at a time,
+// and at least doubled, so remaps stay rare whatever the tensor size
+static const size_t VOXEL_GROW_BYTES {64 * 1024 * 1024};
+
+// Constructor
+DVSVoxelGrid::DVSVoxelGrid()
+    : _bins(0), _window(0), _frame(0), _done(false), _fd(-1),
+      _map(nullptr), _mapSize(0), _capacity(0), _count(0), _tensorBytes(0)
+{
+
+}
+
+// Destructor
+DVSVoxelGrid::~DVSVoxelGrid()
+{
+    close();
+}
+
+// Open method, window is the number of frames per tensor. An empty path
+// keeps the grid in memory only (read it with getGrid() after endFrames()).
+bool DVSVoxelGrid::open(const std::string& path, const size_t bins,
+                        const size_t window, const int rows, const int cols)
+{
+    close();
+    if(bins == 0 || window == 0)
+    {
+        std::cerr << "Voxel. Bins and window must be positive!\n";
+        return false;
+    }
+
+    _bins = bins;
+    _window = window;
+    _frame = 0;
+    _done = false;
+    _count = 0;
+    _grid = cv::Mat::zeros(static_cast<int>(bins) * rows, cols, CV_32F);
+    _tensorBytes = _grid.total() * sizeof(float);
+
+    if(path.empty())
+    {
+        return true;
+    }
+
+    // Never truncate, tensors of an earlier run would be silently lost
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(_fd < 0)
+    {
+        std::cerr << "Voxel. Cannot open " << path << ": " << std::strerror(errno) << "!\n";
+        return false;
+    }
+    struct stat st;
+    if(fstat(_fd, &st) != 0 || st.st_size > 0)
+    {
+        std::cerr << "Voxel. Dataset " << path << " already exists and is not empty!\n";
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+    if(!_reserve(_growStep()))
+    {
+        close();
+        return false;
+    }
+
+    VoxelHeader* header {reinterpret_cast<VoxelHeader*>(_map)};
+    std::memcpy(header->magic, "DVSVOXEL", sizeof(header->magic));
+    header->version = 1;
+    header->bins = static_cast<uint32_t>(bins);
+    header->height = static_cast<uint32_t>(rows);
+    header->width = static_cast<uint32_t>(cols);
+    header->count = 0;
+    return true;
+}
+
+// Unmap and cut the file to the written tensors, a partial window is dropped
+void DVSVoxelGrid::close()
+{
+    if(_map != nullptr)
+    {
+        munmap(_map, _mapSize);
+        _map = nullptr;
+        _mapSize = 0;
+    }
+    if(_fd >= 0)
+    {
+        if(ftruncate(_fd, VOXEL_HEADER_BYTES + _count * _tensorBytes) != 0)
+        {
+            std::cerr << "Voxel. Cannot trim dataset file: " << std::strerror(errno) << "!\n";
+        }
+        ::close(_fd);
+        _fd = -1;
+    }
+    _capacity = 0;
+}
+
+// Call before a pass: clears the grid once the previous window was emitted
+void DVSVoxelGrid::beginFrames()
+{
+    if(_done)
+    {
+        _grid.setTo(cv::Scalar(0));
+        _done = false;
+    }
+}
+
+// Call after a pass over frames frames (never past the window end, see
+// getRemaining()). Returns true when the pass completed a window, the grid
+// then holds the finished tensor until the next beginFrames().
+bool DVSVoxelGrid::endFrames(const size_t frames)
+{
+    _frame += frames;
+    if(_frame < _window)
+    {
+        return false;
+    }
+
+    _frame = 0;
+    _done = true;
+    if(_fd >= 0 && !_emit())
+    {
+        std::cerr << "Voxel. Dataset write failed, file output disabled\n";
+        close();
+    }
+    return true;
+}
+
+// Grow the file and the mapping to hold tensors tensors
+bool DVSVoxelGrid::_reserve(const size_t tensors)
+{
+    const size_t bytes {VOXEL_HEADER_BYTES + tensors * _tensorBytes};
+    if(ftruncate(_fd, bytes) != 0)
+    {
+        std::cerr << "Voxel. Cannot grow dataset file: " << std::strerror(errno) << "!\n";
+        return false;
+    }
+    if(_map != nullptr)
+    {
+        munmap(_map, _mapSize);
+        _map = nullptr;
+    }
+
+    void* map {mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0)};
+    if(map == MAP_FAILED)
+    {
+        std::cerr << "Voxel. Cannot map dataset file: " << std::strerror(errno) << "!\n";
+        _mapSize = 0;
+        return false;
+    }
+    _map = static_cast<uint8_t*>(map);
+    _mapSize = bytes;
+    _capacity = tensors;
+    return true;
+}
+
+// Tensors to add on growth: VOXEL_GROW_BYTES rounded up to whole tensors,
+// or the current capacity when that is larger
+size_t DVSVoxelGrid::_growStep() const
+{
+    const size_t step {(VOXEL_GROW_BYTES + _tensorBytes - 1) / _tensorBytes};
+    return std::max(step, _capacity);
+}
+
+// Append the grid as the next tensor of the dataset
+bool DVSVoxelGrid::_emit()
+{
+    if(_count == _capacity && !_reserve(_capacity + _growStep()))
+    {
+        return false;
+    }
+
+    std::memcpy(_map + VOXEL_HEADER_BYTES + _count * _tensorBytes,
+                _grid.data, _tensorBytes);
+    ++_count;
+    reinterpret_cast<VoxelHeader*>(_map)->count = _count;
+    return true;
+}
+
+// Get parameter methods
+cv::Mat& DVSVoxelGrid::getGrid()
+{
+    return _grid;
+}
+
+size_t DVSVoxelGrid::getBins() const
+{
+    return _bins;
+}
+
+size_t DVSVoxelGrid::getWindow() const
+{
+    return _window;
+}
+
+// Frames left in the current window
+size_t DVSVoxelGrid::getRemaining() const
+{
+    return _window - _frame;
+}
+
+size_t DVSVoxelGrid::getCount() const
+{
+    return _count;
+}
+
+bool DVSVoxelGrid::isOpened() const
+{
+    return !_grid.empty();
+}
@@ -1,5 +1,8 @@
 // STL
 #include <iostream> // for I/O stream
+#include <sstream> // for parsing parameter lists
+#include <stdexcept> // for list parse errors
+#include <vector> // for parameter lists
 
 // OpenCV
 #include <opencv2/core.hpp> // core library
@@ -10,6 +13,43 @@
 
 // pyDVS
 #include "dvs_emu.hpp"
+#include "dvs_sweep.hpp"
+
+// Parse a comma separated list of values of flag, falls back to a single
+// value. Prints an error and returns false on a malformed value.
+static bool parseList(const std::string& flag, const std::string& list,
+                      const float fallback, std::vector<float>& values)
+{
+    values.clear();
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (item.empty())
+        {
+            continue;
+        }
+        try
+        {
+            size_t used {0};
+            values.push_back(std::stof(item, &used));
+            if (used != item.size())
+            {
+                throw std::invalid_argument(item);
+            }
+        }
+        catch (const std::logic_error&)
+        {
+            std::cerr << "Error. Invalid value " << item << " in " << flag << "!\n";
+            return false;
+        }
+    }
+    if (values.empty())
+    {
+        values.push_back(fallback);
+    }
+    return true;
+}
 
 int main(int argc, char *argv[])
 {
@@ -22,7 +62,9 @@ int main(int argc, char *argv[])
     enum Errors
     {
         NO_ERROR,
-        UNREADABLE_VIDEO
+        UNREADABLE_VIDEO,
+        UNWRITABLE_SUMMARY,
+        INVALID_ARGUMENT
     };
 
     // CLI argument parser keys
@@ -42,7 +84,27 @@ int main(int argc, char *argv[])
                             "{adapt-down            | 1.0                   | pyDVS emulator adapt down         }"
                             "{save-proc-vid         |                       | save processed frames             }"
                             "{proc-vid-save-loc     | ../processed_frames/  | location to save processed frames }"
-                            "{proc-vid-name         | events.avi            | name of event frames video        }" };
+                            "{proc-vid-name         | events.avi            | name of event frames video        }"
+                            "{raw-format            |                       | raw input: gray8, bgr24, y4m      }"
+                            "{raw-width             | 0                     | raw input frame width             }"
+                            "{raw-height            | 0                     | raw input frame height            }"
+                            "{raw-fps               | 30                    | raw input frame rate              }"
+                            "{pyramid               | 1                     | event pyramid levels              }"
+                            "{refractory            | 0                     | refractory period in frames       }"
+                            "{voxel-out             |                       | voxel grid dataset file           }"
+                            "{voxel-bins            | 5                     | voxel grid time bins              }"
+                            "{voxel-window          | 10                    | voxel grid window in frames       }"
+                            "{voxel-window-ms       | 0                     | voxel grid window in milliseconds }"
+                            "{color                 |                       | per channel (BGR) color events    }"
+                            "{state-storage         | fp32                  | ref/thr storage: fp32, fp16, bf16 }"
+                            "{state-layout          | planar                | state layout: planar, interleaved }"
+                            "{batch                 | 1                     | frames per kernel pass, offline   }"
+                            "{sweep                 |                       | run parameter sweep               }"
+                            "{sweep-thr             |                       | sweep thresholds, comma separated }"
+                            "{sweep-rel-rate        |                       | sweep relax rates                 }"
+                            "{sweep-adapt-up        |                       | sweep adapt up values             }"
+                            "{sweep-adapt-down      |                       | sweep adapt down values           }"
+                            "{sweep-out             | sweep_summary.csv     | sweep summary file                }" };
 
     cv::CommandLineParser args(argc, argv, keys);
 
@@ -203,6 +265,133 @@ int main(int argc, char *argv[])
             std::cout << "Processed video name.\n\n";
         }
 
+        // Details for flags on raw input
+        else if (   args.get<std::string>("h")     == "raw-format"  ||
+                    args.get<std::string>("?")     == "raw-format"  ||
+                    args.get<std::string>("help")  == "raw-format"  ||
+                    args.get<std::string>("usage") == "raw-format"  )
+        {
+            std::cout << "Read uncompressed frames from vid-name instead of decoding it: gray8, bgr24 or y4m.\n"
+                      << "Use vid-name=- for stdin, a FIFO path, or a file (memory mapped).\n"
+                      << "gray8 and bgr24 need raw-width and raw-height, y4m reads them from its header.\n\n";
+        }
+
+        // Details for flag on event pyramid
+        else if (   args.get<std::string>("h")     == "pyramid" ||
+                    args.get<std::string>("?")     == "pyramid" ||
+                    args.get<std::string>("help")  == "pyramid" ||
+                    args.get<std::string>("usage") == "pyramid" )
+        {
+            std::cout << "Number of event pyramid levels, each halves the resolution of the previous one.\n"
+                      << "All levels are computed in the same pass, shown with show-event-frame.\n\n";
+        }
+
+        // Details for flag on refractory period
+        else if (   args.get<std::string>("h")     == "refractory" ||
+                    args.get<std::string>("?")     == "refractory" ||
+                    args.get<std::string>("help")  == "refractory" ||
+                    args.get<std::string>("usage") == "refractory" )
+        {
+            std::cout << "Number of frames a pixel stays silent after it fired (0 = off, max 32766).\n"
+                      << "Not applied to color events nor to pyramid levels above full resolution.\n\n";
+        }
+
+        // Details for flag on voxel grid output
+        else if (   args.get<std::string>("h")     == "voxel-out" ||
+                    args.get<std::string>("?")     == "voxel-out" ||
+                    args.get<std::string>("help")  == "voxel-out" ||
+                    args.get<std::string>("usage") == "voxel-out" )
+        {
+            std::cout << "Write a voxel grid (voxel-bins x height x width, float32) per window of events to this file.\n"
+                      << "Windows are voxel-window frames long, or voxel-window-ms milliseconds when set.\n"
+                      << "Every frame adds its +1/-1 events to its two nearest time bins (bilinear weights).\n"
+                      << "The file has a 32 byte header, then read it with np.memmap(path, np.float32, offset=32).\n"
+                      << "An existing non-empty file is never overwritten, voxel output is then disabled.\n\n";
+        }
+
+        // Details for flag on color events
+        else if (   args.get<std::string>("h")     == "color"   ||
+                    args.get<std::string>("?")     == "color"   ||
+                    args.get<std::string>("help")  == "color"   ||
+                    args.get<std::string>("usage") == "color"   )
+        {
+            std::cout << "Toggle to emulate a color event camera. Each BGR channel keeps its own state,\n"
+                      << "event frame channels hold +1/-1 per channel (shown around mid gray).\n\n";
+        }
+
+        // Details for flag on state storage
+        else if (   args.get<std::string>("h")     == "state-storage"   ||
+                    args.get<std::string>("?")     == "state-storage"   ||
+                    args.get<std::string>("help")  == "state-storage"   ||
+                    args.get<std::string>("usage") == "state-storage"   )
+        {
+            std::cout << "Storage format of the reference and threshold state: fp32, fp16 or bf16.\n"
+                      << "Half precision cuts state memory traffic, the difference frame is then empty.\n"
+                      << "It keeps 11 (fp16) or 8 (bf16) significant bits: rel-rate, adapt-up and adapt-down\n"
+                      << "within 0.05% (fp16) or 0.4% (bf16) of 1 are rounded away and freeze the state.\n\n";
+        }
+
+        // Details for flag on state layout
+        else if (   args.get<std::string>("h")     == "state-layout"    ||
+                    args.get<std::string>("?")     == "state-layout"    ||
+                    args.get<std::string>("help")  == "state-layout"    ||
+                    args.get<std::string>("usage") == "state-layout"    )
+        {
+            std::cout << "Memory layout of the emulator state: planar or interleaved.\n"
+                      << "Interleaved packs reference and threshold per tile of pixels, the difference frame is then empty.\n\n";
+        }
+
+        // Details for flag on batched offline processing
+        else if (   args.get<std::string>("h")     == "batch"   ||
+                    args.get<std::string>("?")     == "batch"   ||
+                    args.get<std::string>("help")  == "batch"   ||
+                    args.get<std::string>("usage") == "batch"   )
+        {
+            std::cout << "Number of frames processed per kernel pass. Values above 1 run headless,\n"
+                      << "keeping the emulator state in cache across frames for offline throughput.\n\n";
+        }
+
+        // Details for flag on parameter sweep
+        else if (   args.get<std::string>("h")     == "sweep"   ||
+                    args.get<std::string>("?")     == "sweep"   ||
+                    args.get<std::string>("help")  == "sweep"   ||
+                    args.get<std::string>("usage") == "sweep"   )
+        {
+            std::cout << "Toggle to run every combination of the sweep-* lists over the stream.\n"
+                      << "Each frame is decoded once and shared by all configurations.\n\n";
+        }
+
+        // Details for flags on sweep parameter lists
+        else if (   args.get<std::string>("h")     == "sweep-thr"           ||
+                    args.get<std::string>("?")     == "sweep-thr"           ||
+                    args.get<std::string>("help")  == "sweep-thr"           ||
+                    args.get<std::string>("usage") == "sweep-thr"           ||
+                    args.get<std::string>("h")     == "sweep-rel-rate"      ||
+                    args.get<std::string>("?")     == "sweep-rel-rate"      ||
+                    args.get<std::string>("help")  == "sweep-rel-rate"      ||
+                    args.get<std::string>("usage") == "sweep-rel-rate"      ||
+                    args.get<std::string>("h")     == "sweep-adapt-up"      ||
+                    args.get<std::string>("?")     == "sweep-adapt-up"      ||
+                    args.get<std::string>("help")  == "sweep-adapt-up"      ||
+                    args.get<std::string>("usage") == "sweep-adapt-up"      ||
+                    args.get<std::string>("h")     == "sweep-adapt-down"    ||
+                    args.get<std::string>("?")     == "sweep-adapt-down"    ||
+                    args.get<std::string>("help")  == "sweep-adapt-down"    ||
+                    args.get<std::string>("usage") == "sweep-adapt-down"    )
+        {
+            std::cout << "Comma separated values to sweep, e.g. 10,20,30.\n"
+                      << "An empty list uses the matching single value flag.\n\n";
+        }
+
+        // Details for sweep summary file
+        else if (   args.get<std::string>("h")     == "sweep-out"   ||
+                    args.get<std::string>("?")     == "sweep-out"   ||
+                    args.get<std::string>("help")  == "sweep-out"   ||
+                    args.get<std::string>("usage") == "sweep-out"   )
+        {
+            std::cout << "CSV file to write per configuration event statistics to.\n\n";
+        }
+
         // Showing general usage instructions
         args.printMessage();
 
@@ -226,6 +415,22 @@ int main(int argc, char *argv[])
     const bool saveProcVid              { args.has("save-proc-vid") }; // save processed video
     const std::string procVidSaveLoc    { args.get<std::string>("proc-vid-save-loc") }; // processed video save location
     const std::string procVidName       { args.get<std::string>("proc-vid-name") }; // processed video name
+    const std::string rawFormat         { args.get<std::string>("raw-format") }; // raw input format
+    const size_t rawWidth               { args.get<size_t>("raw-width") }; // raw input frame width
+    const size_t rawHeight              { args.get<size_t>("raw-height") }; // raw input frame height
+    const size_t rawFPS                 { args.get<size_t>("raw-fps") }; // raw input frame rate
+    const int pyramid                   { args.get<int>("pyramid") }; // event pyramid levels
+    const size_t refractory             { args.get<size_t>("refractory") }; // refractory period in frames
+    const std::string voxelOut          { args.get<std::string>("voxel-out") }; // voxel grid dataset file
+    const size_t voxelBins              { args.get<size_t>("voxel-bins") }; // voxel grid time bins
+    const size_t voxelWindow            { args.get<size_t>("voxel-window") }; // voxel grid window in frames
+    const float voxelWindowMs           { args.get<float>("voxel-window-ms") }; // voxel grid window in ms
+    const bool color                    { args.has("color") }; // per channel color events
+    const std::string stateStorage      { args.get<std::string>("state-storage") }; // ref/thr storage format
+    const std::string stateLayout       { args.get<std::string>("state-layout") }; // ref/thr layout
+    const size_t batch                  { args.get<size_t>("batch") }; // frames per kernel pass
+    const bool sweep                    { args.has("sweep") }; // run parameter sweep
+    const std::string sweepOut          { args.get<std::string>("sweep-out") }; // sweep summary file
 
     if (showAllFrame)
     {
@@ -236,11 +441,105 @@ int main(int argc, char *argv[])
         showEventFrame = true;
     }
 
+    // The sweep runs on the gray float input only
+    if (color && sweep)
+    {
+        std::cerr << "Error. sweep does not support color input!\n";
+        return INVALID_ARGUMENT;
+    }
+    // Every level halves the frame, more than a few dozen cannot exist
+    if (pyramid < 1 || pyramid > DVS_PYRAMID_MAX_LEVELS)
+    {
+        std::cerr << "Error. pyramid must be between 1 and " << DVS_PYRAMID_MAX_LEVELS << "!\n";
+        return INVALID_ARGUMENT;
+    }
+
+    // The batched pass runs full resolution only
+    if (batch > 1 && pyramid > 1)
+    {
+        std::cerr << "Error. batch does not support pyramid levels!\n";
+        return INVALID_ARGUMENT;
+    }
+    std::vector<float> sweepThr, sweepRelRate, sweepAdaptUp, sweepAdaptDown;
+    if (sweep &&
+        (!parseList("sweep-thr", args.get<std::string>("sweep-thr"), thr, sweepThr) ||
+         !parseList("sweep-rel-rate", args.get<std::string>("sweep-rel-rate"), relRate, sweepRelRate) ||
+         !parseList("sweep-adapt-up", args.get<std::string>("sweep-adapt-up"), adaptUp, sweepAdaptUp) ||
+         !parseList("sweep-adapt-down", args.get<std::string>("sweep-adapt-down"), adaptDown, sweepAdaptDown)))
+    {
+        return INVALID_ARGUMENT;
+    }
+    if (color && refractory > 0)
+    {
+        std::cerr << "Warning. refractory is ignored in color mode\n";
+    }
+    if (color && !voxelOut.empty())
+    {
+        std::cerr << "Warning. voxel-out is ignored in color mode\n";
+    }
+
     // PyDVS object
     PyDVS DVS;
+    DVS.setColor(color);
+    DVS.setPyramid(static_cast<size_t>(pyramid));
+    DVS.setRefractory(refractory);
+    if (!voxelOut.empty())
+    {
+        DVS.setVoxelGrid(voxelOut, voxelBins, voxelWindow, voxelWindowMs);
+    }
+    if (stateStorage == "fp16")
+    {
+        DVS.setStorage(DVS_STORAGE_FP16);
+    }
+    else if (stateStorage == "bf16")
+    {
+        DVS.setStorage(DVS_STORAGE_BF16);
+    }
+    else if (stateStorage != "fp32")
+    {
+        std::cerr << "Error. Unknown state-storage " << stateStorage
+                  << ", expected fp32, fp16 or bf16!\n";
+        return INVALID_ARGUMENT;
+    }
+    if (stateLayout == "interleaved")
+    {
+        DVS.setLayout(DVS_LAYOUT_INTERLEAVED);
+    }
+    else if (stateLayout != "planar")
+    {
+        std::cerr << "Error. Unknown state-layout " << stateLayout
+                  << ", expected planar or interleaved!\n";
+        return INVALID_ARGUMENT;
+    }
 
     // Check video stream
-    bool ok { DVS.init(vidName, thr, relRate, adaptUp, adaptDown) };
+    bool ok {false};
+    if (rawFormat.empty())
+    {
+        ok = DVS.init(vidName, thr, relRate, adaptUp, adaptDown);
+    }
+    else
+    {
+        int format {DVS_RAW_Y4M};
+        if (rawFormat == "gray8")
+        {
+            format = DVS_RAW_GRAY8;
+        }
+        else if (rawFormat == "bgr24")
+        {
+            format = DVS_RAW_BGR24;
+        }
+        else if (rawFormat != "y4m")
+        {
+            std::cerr << "Error. Unknown raw-format " << rawFormat
+                      << ", expected gray8, bgr24 or y4m!\n";
+            return INVALID_ARGUMENT;
+        }
+        DVS.setWidth(rawWidth);
+        DVS.setHeight(rawHeight);
+        DVS.setFPS(rawFPS);
+        ok = DVS.initRaw(vidName, format, thr, relRate, adaptUp, adaptDown);
+    }
     if(!ok)
     {
         std::cerr << "Unable to open video source.\n";
@@ -248,6 +547,39 @@ int main(int argc, char *argv[])
     }
     std::cout << "Stream is starting...\n";
 
+    // Parameter sweep, headless
+    if (sweep)
+    {
+        DVSSweep DVSGrid;
+        const std::vector<DVSSweepConfig> configs { DVSSweep::grid(
+            sweepThr, sweepRelRate, sweepAdaptUp, sweepAdaptDown) };
+
+        if (!DVSGrid.init(configs, DVS.getWidth(), DVS.getHeight()))
+        {
+            return UNREADABLE_VIDEO;
+        }
+        std::cout << "Sweeping " << DVSGrid.getNumConfigs() << " configurations\n";
+
+        cv::TickMeter sweepTickMeter;
+        sweepTickMeter.start();
+        while (DVS.read())
+        {
+            DVSGrid.update(DVS.getInput());
+        }
+        sweepTickMeter.stop();
+
+        std::cout   << "Processed " << DVSGrid.getNumFrames() << " frames in "
+                    << sweepTickMeter.getTimeSec() << " s\n";
+
+        if (!DVSGrid.writeSummary(sweepOut))
+        {
+            return UNWRITABLE_SUMMARY;
+        }
+        std::cout << "Sweep summary written to " << sweepOut << '\n';
+
+        return NO_ERROR;
+    }
+
     // Windows
     const std::string rawStreamWinName      {"Raw Stream"};
     const std::string refStreamWinName      {"Reference Stream"};
@@ -317,6 +649,32 @@ int main(int argc, char *argv[])
         }
     }
 
+    // Batched offline processing, headless
+    if (batch > 1)
+    {
+        cv::TickMeter batchTickMeter;
+        batchTickMeter.start();
+        size_t frames {0};
+        for (size_t n {DVS.updateBatch(batch)}; n > 0; n = DVS.updateBatch(batch))
+        {
+            if (saveProcVid)
+            {
+                for (size_t i{0}; i < n; ++i)
+                {
+                    eventFrameVideo.write(DVS.getEventsBatch()[i]);
+                }
+            }
+            frames += n;
+        }
+        batchTickMeter.stop();
+
+        std::cout   << "Processed " << frames << " frames in "
+                    << batchTickMeter.getTimeSec() << " s\n";
+
+        eventFrameVideo.release();
+        return NO_ERROR;
+    }
+
     // Show frames
     for(; ok; ok = DVS.update())
     {
@@ -343,7 +701,14 @@ int main(int argc, char *argv[])
         }
         if (showGrayFrame)
         {
-            cv::imshow(grayStreamWinName, DVS.getInput()*(1.0f/255.0f));
+            if (color || DVS.getInput().depth() == CV_8U)
+            {
+                cv::imshow(grayStreamWinName, DVS.getInput());
+            }
+            else
+            {
+                cv::imshow(grayStreamWinName, DVS.getInput()*(1.0f/255.0f));
+            }
         }
         if (showDiffFrame)
         {
@@ -351,7 +716,19 @@ int main(int argc, char *argv[])
         }
         if (showEventFrame)
         {
-            cv::imshow(eventStreamWinName, DVS.getEvents());
+            if (color)
+            {
+                cv::imshow(eventStreamWinName, DVS.getEvents()*0.5f + 0.5f);
+            }
+            else
+            {
+                cv::imshow(eventStreamWinName, DVS.getEvents());
+            }
+            for (size_t level{1}; level < DVS.getLevels(); ++level)
+            {
+                cv::imshow(eventStreamWinName + " 1/" + std::to_string(1 << level),
+                           DVS.getEvents(level));
+            }
         }
 
         // Saving event frames